@@ -0,0 +1,194 @@
+/*=====================================================================
+ *  asset_pack.c  –  mmap'ed voice asset pack (see asset_pack.h)
+ *====================================================================*/
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE           /* madvise() */
+#include "asset_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+extern EmbeddedWav get_embedded_wav(const char *name);
+
+/* -----------------------------------------------------------------
+ *  Active mapping
+ * ----------------------------------------------------------------- */
+typedef struct {
+    unsigned char        *base;     /* start of the mapping            */
+    size_t                len;      /* mapping length                  */
+    const AssetPackEntry *index;    /* points into the mapping         */
+    uint32_t              count;
+} AssetPack;
+
+static AssetPack g_pack = { NULL, 0, NULL, 0 };
+static char      g_pack_path[PATH_MAX];
+static bool      g_pack_locked = false;
+
+/* -----------------------------------------------------------------
+ *  Map + validate a pack file.  Every offset is bounds checked once
+ *  here so lookups never have to.
+ * ----------------------------------------------------------------- */
+static bool pack_map(const char *path, AssetPack *out)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        fprintf(stderr, "asset pack: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(AssetPackHeader)) {
+        fprintf(stderr, "asset pack: %s: too small\n", path);
+        close(fd);
+        return false;
+    }
+
+    size_t len = (size_t)st.st_size;
+    unsigned char *base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                          /* the mapping keeps the inode */
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    const AssetPackHeader *hdr = (const AssetPackHeader *)base;
+    const char *why = NULL;
+
+    if (memcmp(hdr->magic, ASSET_PACK_MAGIC, sizeof hdr->magic) != 0)
+        why = "bad magic";
+    else if (hdr->version != ASSET_PACK_VERSION)
+        why = "unsupported version";
+    else if (hdr->file_size != len)
+        why = "truncated";
+    else if (hdr->index_offset > len ||
+             hdr->index_offset % _Alignof(AssetPackEntry) != 0 ||
+             (len - hdr->index_offset) / sizeof(AssetPackEntry) < hdr->count ||
+             hdr->data_offset > len)
+        why = "index out of range";
+
+    const AssetPackEntry *index =
+        why ? NULL : (const AssetPackEntry *)(base + hdr->index_offset);
+
+    for (uint32_t i = 0; !why && i < hdr->count; ++i) {
+        const AssetPackEntry *e = &index[i];
+        if (memchr(e->name, '\0', sizeof e->name) == NULL)
+            why = "unterminated name";
+        else if (e->offset > len || e->size > len - e->offset ||
+                 e->size > UINT_MAX)
+            why = "blob out of range";
+        else if (i > 0 && strcmp(index[i - 1].name, e->name) >= 0)
+            why = "index not sorted";
+    }
+
+    if (why) {
+        fprintf(stderr, "asset pack: %s: %s\n", path, why);
+        munmap(base, len);
+        return false;
+    }
+
+    /* The index is hit on every lookup, the blobs only a few at a time
+       per announcement – tell the kernel not to read ahead on those. */
+    madvise(base, (size_t)hdr->data_offset, MADV_WILLNEED);
+    if (hdr->data_offset < len)
+        madvise(base + hdr->data_offset, len - hdr->data_offset,
+                MADV_RANDOM);
+
+    if (g_pack_locked && mlock(base, len) == -1)
+        fprintf(stderr, "asset pack: mlock: %s\n", strerror(errno));
+
+    out->base  = base;
+    out->len   = len;
+    out->index = index;
+    out->count = hdr->count;
+    return true;
+}
+
+static void pack_unmap(AssetPack *p)
+{
+    if (p->base)
+        munmap(p->base, p->len);
+    *p = (AssetPack){ NULL, 0, NULL, 0 };
+}
+
+/*=====================================================================
+ *  PUBLIC API
+ *====================================================================*/
+bool asset_pack_open(const char *path)
+{
+    /* Remember an absolute path: the daemon chdir()s to / and the
+       reload must find the same file again. */
+    char resolved[PATH_MAX];
+    if (!realpath(path, resolved)) {
+        fprintf(stderr, "asset pack: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    AssetPack fresh;
+    if (!pack_map(resolved, &fresh))
+        return false;
+
+    pack_unmap(&g_pack);
+    g_pack = fresh;
+    snprintf(g_pack_path, sizeof g_pack_path, "%s", resolved);
+    return true;
+}
+
+bool asset_pack_reload(void)
+{
+    if (!g_pack_path[0])
+        return true;                    /* embedded assets only */
+
+    /* Build the new mapping completely before touching the live one, so
+       a half‑written or corrupt file never replaces a working pack.
+       Callers reload between announcements, when no decoded segment
+       still points into the old mapping. */
+    AssetPack fresh;
+    if (!pack_map(g_pack_path, &fresh))
+        return false;
+
+    AssetPack old = g_pack;
+    g_pack = fresh;
+    pack_unmap(&old);
+    return true;
+}
+
+void asset_pack_set_locked(bool locked)
+{
+    g_pack_locked = locked;
+    if (!g_pack.base)
+        return;
+    if (locked && mlock(g_pack.base, g_pack.len) == -1)
+        fprintf(stderr, "asset pack: mlock: %s\n", strerror(errno));
+    else if (!locked)
+        munlock(g_pack.base, g_pack.len);
+}
+
+void asset_pack_close(void)
+{
+    pack_unmap(&g_pack);
+    g_pack_path[0] = '\0';
+}
+
+static int entry_cmp(const void *key, const void *elem)
+{
+    return strcmp(key, ((const AssetPackEntry *)elem)->name);
+}
+
+EmbeddedWav asset_get(const char *name)
+{
+    if (g_pack.base) {
+        const AssetPackEntry *e = bsearch(name, g_pack.index, g_pack.count,
+                                          sizeof *g_pack.index, entry_cmp);
+        if (e)
+            return (EmbeddedWav){ .name = e->name,
+                                  .data = g_pack.base + e->offset,
+                                  .size = (unsigned int)e->size };
+    }
+    return get_embedded_wav(name);
+}
@@ -0,0 +1,66 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+/* -------------------------------------------------------------
+ *  External voice asset pack.
+ *
+ *  A pack is a single read‑only file that is mmap'ed by the daemon:
+ *
+ *      +----------------------+  offset 0
+ *      | AssetPackHeader      |
+ *      +----------------------+  header.index_offset
+ *      | AssetPackEntry[n]    |  sorted by name (bsearch‑able)
+ *      +----------------------+  header.data_offset
+ *      | WAV data, each blob  |
+ *      | ASSET_PACK_ALIGN'ed  |
+ *      +----------------------+
+ *
+ *  Every blob is a complete 16‑bit PCM WAV file, so the rest of the
+ *  audio path does not care whether an asset came from the pack or
+ *  from the table compiled into the binary.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include "wav_table.h"        /* EmbeddedWav */
+
+#define ASSET_PACK_MAGIC     "CBTPACK1"
+#define ASSET_PACK_VERSION   1u
+#define ASSET_PACK_ALIGN     4096u    /* page aligned – see madvise() */
+#define ASSET_PACK_NAME_MAX  32
+
+typedef struct {
+    char     magic[8];        /* ASSET_PACK_MAGIC, not NUL terminated */
+    uint32_t version;         /* ASSET_PACK_VERSION                   */
+    uint32_t count;           /* number of entries in the index       */
+    uint64_t index_offset;    /* byte offset of AssetPackEntry[0]     */
+    uint64_t data_offset;     /* byte offset of the first blob        */
+    uint64_t file_size;       /* total size, guards against truncation*/
+} AssetPackHeader;
+
+typedef struct {
+    char     name[ASSET_PACK_NAME_MAX]; /* "num12", NUL terminated     */
+    uint64_t offset;                    /* absolute offset of the blob */
+    uint64_t size;                      /* blob length in bytes        */
+} AssetPackEntry;
+
+/* Map the pack at ‘path’ and make it the active one.  On failure the
+ * previously active pack (if any) stays in place. */
+bool asset_pack_open(const char *path);
+
+/* Re‑open the active pack's path and atomically swap it in.  Used for
+ * SIGHUP hot reload; a broken new file leaves the old mapping live.
+ * A no‑op (returning true) when no pack was ever opened. */
+bool asset_pack_reload(void);
+
+/* Keep the active pack – and every pack reloaded later – mlock'ed.
+ * Best effort: RLIMIT_MEMLOCK may not cover a large pack. */
+void asset_pack_set_locked(bool locked);
+
+/* Unmap the active pack – lookups fall back to the embedded table. */
+void asset_pack_close(void);
+
+/* Look an asset up by name: the pack first, then the embedded table.
+ * Returns {0} when neither knows the name. */
+EmbeddedWav asset_get(const char *name);
+
+#endif /* ASSET_PACK_H */
@@ -7,118 +7,151 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
 #include <alsa/asoundlib.h>
-#include <sndfile.h>
 #include "wav_table.h"
+#include "asset_pack.h"
+#include "dsp.h"
+#include "wav.h"
+#include "trace.h"
+#include "env.h"
 
 /* -----------------------------------------------------------------
  *  Global objects
  * ----------------------------------------------------------------- */
 static snd_pcm_t *pcm_handle = NULL;        /* shared ALSA PCM handle */
+
+/* Counters / modes reported through audio_get_stats() */
+static AudioStats g_stats = { 0 };
 extern EmbeddedWav get_embedded_wav(const char *name);
 
 /* -----------------------------------------------------------------
- *  Helper – virtual‑file object that points to a memory buffer
+ *  Global state for the “play‑queue”
  * ----------------------------------------------------------------- */
+#define CHAIN_MAX_SEGMENTS 16    /* segments tracked per chain */
+
+/* Both chains are allocated up front for this many samples – 30 s of
+   the 16 kHz mono voice – so announcements never realloc; only a
+   longer one grows the buffer (once). */
+#define CHAIN_RESERVE_SAMPLES (16000 * 30)
+
+/* Period buffers are static: 200 ms of 48 kHz stereo.  A larger ALSA
+   period is simply fed in several writes. */
+#define PERIOD_BUF_SAMPLES (48000 * 2 / 5)
+
 typedef struct {
-    const unsigned char *data;   /* pointer to the whole wav file   */
-    sf_count_t          size;    /* total number of bytes           */
-    sf_count_t          pos;     /* current read position (bytes)   */
-} MemFile;
+    const unsigned char *pcm; /* streamed: copied from the asset while
+                                 it plays; NULL once its frames are in
+                                 ‘buf’                                 */
+    size_t   frames;          /* segment length                        */
+    bool     low_prio;        /* ducked by the DSP stage               */
+} ChainSegment;
 
-/* -----------------------------------------------------------------
- *  Global state for the “play‑queue”
- * ----------------------------------------------------------------- */
 typedef struct {
     short *buf;               /* interleaved S16‑LE samples            */
     size_t  frames;           /* number of frames currently stored      */
-    size_t  capacity_frames; /* allocated capacity (in frames)         */
+    size_t  capacity;         /* allocated capacity (in samples)        */
     unsigned int rate;        /* sample rate of the current queue      */
     unsigned int channels;    /* channel count of the current queue    */
+
+    /* The segments, in play order: first those already decoded into
+       ‘buf’, then (streaming mode) those whose header is parsed but
+       whose samples are only decoded, period by period, as they play.
+       The joins between them are where the DSP stage fades. */
+    ChainSegment seg[CHAIN_MAX_SEGMENTS];
+    size_t       nseg;
+
+    struct timespec t_start;  /* first add – for time‑to‑first‑sample */
 } AudioChain;
 
 /* One instance – keep it static so the API does not require a handle */
-static AudioChain g_chain = { NULL, 0, 0, 0, 0 };
+static AudioChain g_chain = { 0 };
 
-/*=====================================================================
- *  Virtual‑IO callbacks (unchanged)
- *====================================================================*/
-static sf_count_t mem_read(void *ptr, sf_count_t count, void *user_data)
+/* Second buffer for the look‑ahead announcement (see audio_chain_stage_*)
+   and the chain that audio_chain_add() currently appends to. */
+static AudioChain  g_staged = { 0 };
+static AudioChain *g_target = &g_chain;
+
+/* Streaming playback (audio_chain_set_streaming) and the period buffer
+   every play copies and processes one period into before writing it –
+   ALSA, or the fan‑out ring, has its own copy once the write returns. */
+static bool  g_streaming = false;
+static bool  g_null_sink = false;
+static short g_period_buf[PERIOD_BUF_SAMPLES];
+
+/* DSP stage settings (audio_set_dsp) */
+static int32_t      g_gain_q15 = DSP_UNITY;
+static int32_t      g_duck_q15 = DSP_UNITY / 2;
+static unsigned int g_fade_ms  = 5;
+
+/* Time‑to‑first‑sample of the most recent audio_chain_play() */
+static unsigned long g_last_ttfs_us = 0;
+
+static int64_t now_ns(void)
 {
-    MemFile *mf = user_data;
-    sf_count_t left = mf->size - mf->pos;
-    if (count > left) count = left;
-    memcpy(ptr, mf->data + mf->pos, (size_t)count);
-    mf->pos += count;
-    return count;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
 }
-static sf_count_t mem_seek(sf_count_t offset, int whence, void *user_data)
+
+static unsigned long elapsed_us(const struct timespec *since)
 {
-    MemFile *mf = user_data;
-    sf_count_t newpos;
-    switch (whence) {
-        case SEEK_SET: newpos = offset;                     break;
-        case SEEK_CUR: newpos = mf->pos + offset;           break;
-        case SEEK_END: newpos = mf->size + offset;          break;
-        default:       return -1;
-    }
-    if (newpos < 0 || newpos > mf->size) return -1;
-    mf->pos = newpos;
-    return newpos;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)((now.tv_sec - since->tv_sec) * 1000000L +
+                           (now.tv_nsec - since->tv_nsec) / 1000);
 }
-static sf_count_t mem_tell(void *user_data)
+
+/* Microseconds from ‘since’ to ‘ns’, a now_ns() time */
+static unsigned long us_until(const struct timespec *since, int64_t ns)
 {
-    return ((MemFile *)user_data)->pos;
+    const int64_t t0 = (int64_t)since->tv_sec * 1000000000 + since->tv_nsec;
+    return ns > t0 ? (unsigned long)((ns - t0) / 1000) : 0;
 }
-static sf_count_t mem_length(void *user_data)
+
+static bool chain_empty(const AudioChain *c)
 {
-    return ((MemFile *)user_data)->size;
+    return c->nseg == 0;
 }
 
-/*=====================================================================
- *  Open a WAV that lives in memory (unchanged)
- *====================================================================*/
-static SNDFILE *sf_open_mem(const unsigned char *buf,
-                            sf_count_t          buflen,
-                            SF_INFO            *sfinfo)
+static void chain_clear_segments(AudioChain *c)
 {
-    static const SF_VIRTUAL_IO vio = {
-        .get_filelen = mem_length,
-        .seek        = mem_seek,
-        .read        = mem_read,
-        .write       = NULL,
-        .tell        = mem_tell
-    };
+    c->nseg = 0;
+}
 
-    MemFile *mf = malloc(sizeof *mf);
-    if (!mf) return NULL;
-    mf->data = buf;
-    mf->size = buflen;
-    mf->pos  = 0;
+static DspParams dsp_params(unsigned int rate)
+{
+    return (DspParams){ .gain_q15    = g_gain_q15,
+                        .duck_q15    = g_duck_q15,
+                        .fade_frames = rate * g_fade_ms / 1000 };
+}
 
-    SNDFILE *snd = sf_open_virtual(&vio, SFM_READ, sfinfo, mf);
-    if (!snd) {
-        free(mf);
-        return NULL;
-    }
-    /* libsndfile will free the MemFile object when sf_close() is called */
-    return snd;
+/* Frames of ‘channels’ that fit the period buffer */
+static size_t period_buf_frames(unsigned int channels)
+{
+    return PERIOD_BUF_SAMPLES / channels;
 }
 
 /*=====================================================================
- *  ALSA HW‑parameter helper (unchanged)
+ *  ALSA HW‑parameter helper
  *====================================================================*/
 static bool set_hw_params(snd_pcm_t *pcm,
                           unsigned int rate,
                           unsigned int channels,
                           snd_pcm_format_t fmt,
+                          unsigned int period_ms,
+                          unsigned int buffer_ms,
                           snd_pcm_uframes_t *period_sz,
                           snd_pcm_uframes_t *buffer_sz)
 {
     snd_pcm_hw_params_t *hw;
     int err;
 
-    snd_pcm_hw_params_malloc(&hw);
+    snd_pcm_hw_params_alloca(&hw);          /* on the stack – no malloc */
     snd_pcm_hw_params_any(pcm, hw);
 
     snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED);
@@ -126,18 +159,19 @@ static bool set_hw_params(snd_pcm_t *pcm,
     snd_pcm_hw_params_set_channels(pcm, hw, channels);
     snd_pcm_hw_params_set_rate_near(pcm, hw, &rate, NULL);
 
-    /* ask for a period of ~10 ms */
-    snd_pcm_uframes_t period = rate / 100;
+    /* ask for a period of ~period_ms (10 ms unless adapted) */
+    snd_pcm_uframes_t period = (snd_pcm_uframes_t)rate * period_ms / 1000;
     snd_pcm_hw_params_set_period_size_near(pcm, hw, &period, NULL);
     *period_sz = period;
 
-    /* buffer = 4 periods (typical) */
+    /* buffer = 4 periods (typical), or ‘buffer_ms’ if that is more */
     snd_pcm_uframes_t buffer = period * 4;
+    if (buffer < (snd_pcm_uframes_t)rate * buffer_ms / 1000)
+        buffer = (snd_pcm_uframes_t)rate * buffer_ms / 1000;
     snd_pcm_hw_params_set_buffer_size_near(pcm, hw, &buffer);
     *buffer_sz = buffer;
 
     err = snd_pcm_hw_params(pcm, hw);
-    snd_pcm_hw_params_free(hw);
     if (err < 0) {
         fprintf(stderr, "ALSA: unable to set HW params: %s\n",
                 snd_strerror(err));
@@ -147,14 +181,809 @@ static bool set_hw_params(snd_pcm_t *pcm,
 }
 
 /*=====================================================================
- *  PUBLIC API – initialisation / clean‑up
+ *  Device configuration shared by both playback paths, and the
+ *  adaptive period policy driven by underrun telemetry.
+ *
+ *  Every play is judged afterwards: ADAPT_GROW_XRUNS underruns since
+ *  the last change double the period (and so the 4‑period buffer), up
+ *  to the configured maximum; ADAPT_SHRINK_PLAYS clean plays in a row
+ *  halve it again, down to the minimum.  Changes apply at the next
+ *  play, never in the middle of one.  Fan‑out devices each run the
+ *  same policy on their own underruns.
  *====================================================================*/
-bool audio_init(void)
+#define ADAPT_GROW_XRUNS    2
+#define ADAPT_SHRINK_PLAYS  20
+#define PERIOD_MS_DEFAULT   10
+
+static struct {
+    unsigned int      rate, channels;   /* configured format, 0 = none */
+    unsigned int      period_ms;        /* configured period           */
+    unsigned int      queue_ms;         /* buffer asked to hold this   */
+    snd_pcm_uframes_t period_frames;
+    snd_pcm_uframes_t buffer_frames;
+} g_hw = { 0, 0, 0, 0, 0, 0 };
+
+typedef struct {
+    unsigned int  want_ms;              /* period for the next play     */
+    unsigned long xruns;                /* since the last size change   */
+    unsigned long clean_plays;          /* consecutive, no underrun     */
+} Adapt;
+
+/* bounds (CABATA_PERIOD_MS_*), and the policy of the single device */
+static unsigned int g_period_min_ms = 0, g_period_max_ms = 0;
+static Adapt        g_adapt = { 0, 0, 0 };
+
+static void adapt_init(void)
+{
+    g_period_min_ms = env_uint("CABATA_PERIOD_MS_MIN", PERIOD_MS_DEFAULT,
+                               1, 1000);
+    g_period_max_ms = env_uint("CABATA_PERIOD_MS_MAX", 8 * PERIOD_MS_DEFAULT,
+                               1, 1000);
+    if (g_period_max_ms < g_period_min_ms)
+        g_period_max_ms = g_period_min_ms;
+    g_adapt.want_ms = g_period_min_ms;
+}
+
+/* Feed the outcome of one play on device ‘who’ (NULL: the single one)
+   into policy ‘a’.  The fan‑out threads call it too, hence the atomic
+   counters. */
+static void adapt_update(Adapt *a, unsigned long xruns, const char *who)
+{
+    if (xruns) {
+        a->xruns += xruns;
+        a->clean_plays = 0;
+        if (a->xruns >= ADAPT_GROW_XRUNS && a->want_ms < g_period_max_ms) {
+            a->want_ms *= 2;
+            if (a->want_ms > g_period_max_ms)
+                a->want_ms = g_period_max_ms;
+            a->xruns = 0;
+            __atomic_fetch_add(&g_stats.period_grows, 1, __ATOMIC_RELAXED);
+            fprintf(stderr, "ALSA%s%s: underruns, period -> %u ms\n",
+                    who ? " " : "", who ? who : "", a->want_ms);
+        }
+    } else if (++a->clean_plays >= ADAPT_SHRINK_PLAYS) {
+        a->clean_plays = 0;
+        a->xruns = 0;
+        if (a->want_ms > g_period_min_ms) {
+            a->want_ms /= 2;
+            if (a->want_ms < g_period_min_ms)
+                a->want_ms = g_period_min_ms;
+            __atomic_fetch_add(&g_stats.period_shrinks, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/*=====================================================================
+ *  Fan‑out – several devices from one stream (CABATA_DEVICES)
+ *
+ *  The playback paths produce their periods exactly as for a single
+ *  device, but pcm_write_frames() publishes each one into a broadcast
+ *  ring instead of writing it.  Every device has a thread with its own
+ *  read position that copies slots out and writes them to its PCM, so
+ *  a device that blocks holds up only itself.  The producer never
+ *  waits for the slowest device: one that falls more than
+ *  FANOUT_BEHIND slots behind the fastest, or gets lapped, skips ahead.
+ *
+ *  It does keep pace with the fastest, at most FANOUT_BEHIND slots
+ *  ahead of it, and pcm_finish() waits for the fastest to play out the
+ *  end‑of‑play slot – so a play returns when it would on one device,
+ *  and its onset is when a device took its first slot.  A cue may run
+ *  as far ahead as it is long and is not waited for, as the single
+ *  device's buffer holds all of it.  If no device moves at all for
+ *  FANOUT_STALL_MS the producer stops waiting.
+ *
+ *  The PCMs are non‑blocking and polled every FANOUT_POLL_MS, so a
+ *  device drops what it holds as soon as the daemon quits – or, as the
+ *  single device does in pcm_configure(), when the next play cuts off
+ *  a cue it is still playing out.  Each device adapts its own period
+ *  to its own underruns.
+ *
+ *  Drift: each device's playback position (frames written minus
+ *  snd_pcm_delay()) is compared with CLOCK_MONOTONIC since its stream
+ *  started.  When the smoothed difference moves more than
+ *  FANOUT_DRIFT_MS from where it settled, one frame is repeated (the
+ *  device runs fast) or dropped (slow), so every room stays on the
+ *  same clock however long a play runs.
+ *
+ *  With the null sink the devices open no PCM and take as long over a
+ *  slot as a real one would: fan‑out without hardware, for tests.
+ *====================================================================*/
+#define FANOUT_SLOTS        64           /* power of two               */
+#define FANOUT_SLOT_SAMPLES 2048         /* 128 ms of 16 kHz mono      */
+#define FANOUT_BEHIND       4            /* slots behind the fastest,
+                                            and the producer's least
+                                            lead                       */
+#define FANOUT_STALL_MS     500
+#define FANOUT_POLL_MS      50
+#define FANOUT_DRIFT_MS     1
+#define FANOUT_SETTLE       8            /* writes before drift counts */
+
+typedef struct {
+    uint64_t     seq;                    /* index + 1 once written     */
+    unsigned int rate, channels;
+    unsigned int frames;                 /* 0: a play ends – drain     */
+    short        pcm[FANOUT_SLOT_SAMPLES];
+} FanoutSlot;
+
+typedef struct {
+    char          name[64];
+    snd_pcm_t    *pcm;                   /* NULL with the null sink    */
+    pthread_t     thread;
+    uint64_t      tail;                  /* next slot to read (atomic) */
+    uint64_t      drained;               /* end slot played out + 1 (atomic) */
+    bool          hold;                  /* audio_fanout_hold() (atomic) */
+    unsigned int  rate, channels;        /* configured, 0 = none       */
+    unsigned int  period_ms;
+    Adapt         adapt;                 /* this device's period policy */
+    unsigned long xruns_judged;          /* underruns fed to it so far */
+
+    /* drift of the current stream, started by its first write */
+    bool          running;
+    int64_t       t0_ns;
+    uint64_t      written;
+    unsigned int  writes;
+    double        err, base;             /* frames, smoothed / settled */
+
+    /* AudioDeviceStats (atomic) */
+    unsigned long underruns, skipped, plays, period_frames;
+    long          drift_frames;
+} FanoutDevice;
+
+static struct {
+    FanoutSlot      ring[FANOUT_SLOTS];
+    uint64_t        head;                /* next slot to write (atomic) */
+    uint64_t        cut;                 /* slots before it are dropped
+                                            (atomic)                    */
+    uint64_t        stalled_at;          /* fastest tail when we gave up */
+    uint64_t        onset_slot;          /* first slot of the play      */
+    uint64_t        lead;                /* slots it may run ahead      */
+    int64_t         onset_ns;            /* a device took it (atomic)   */
+    bool            unwaited;            /* the last play was a cue     */
+    FanoutDevice    dev[AUDIO_MAX_DEVICES];
+    unsigned int    ndev;
+    bool            quit;                /* (atomic)                    */
+    pthread_mutex_t lock;
+    pthread_cond_t  data;                /* head moved (readers wait)   */
+    pthread_cond_t  progress;            /* a device moved (producer)   */
+} g_fan = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t fanout_fastest(void)
+{
+    uint64_t t = 0;
+    for (unsigned int i = 0; i < g_fan.ndev; ++i) {
+        uint64_t x = __atomic_load_n(&g_fan.dev[i].tail, __ATOMIC_ACQUIRE);
+        if (x > t)
+            t = x;
+    }
+    return t;
+}
+
+static void sleep_ns(int64_t ns)
+{
+    struct timespec ts = { .tv_sec  = (time_t)(ns / 1000000000),
+                           .tv_nsec = (long)(ns % 1000000000) };
+    nanosleep(&ts, NULL);
+}
+
+/* ---------- producer side (the playback path) ---------- */
+
+/* What the producer waits for, given a slot index */
+static bool fanout_has_room(uint64_t head)
+{
+    return head - fanout_fastest() < g_fan.lead;
+}
+
+static bool fanout_played_out(uint64_t slot)
+{
+    for (unsigned int i = 0; i < g_fan.ndev; ++i)
+        if (__atomic_load_n(&g_fan.dev[i].drained, __ATOMIC_ACQUIRE) > slot)
+            return true;
+    return false;
+}
+
+static bool fanout_started(uint64_t unused)
+{
+    (void)unused;
+    return __atomic_load_n(&g_fan.onset_ns, __ATOMIC_ACQUIRE) != 0;
+}
+
+static struct timespec fanout_deadline(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    t.tv_nsec += FANOUT_STALL_MS * 1000000L;
+    t.tv_sec  += t.tv_nsec / 1000000000L;
+    t.tv_nsec %= 1000000000L;
+    return t;
+}
+
+/* Block until ready(slot) – for as long as the devices move: after
+   FANOUT_STALL_MS without any progress give up, and do not wait again
+   until one of them moves on. */
+static void fanout_wait(bool (*ready)(uint64_t), uint64_t slot)
+{
+    if (ready(slot) || fanout_fastest() == g_fan.stalled_at)
+        return;
+
+    struct timespec until = fanout_deadline();
+    pthread_mutex_lock(&g_fan.lock);
+    while (!ready(slot)) {
+        if (pthread_cond_timedwait(&g_fan.progress, &g_fan.lock,
+                                   &until) == ETIMEDOUT) {
+            g_fan.stalled_at = fanout_fastest();
+            fprintf(stderr, "fan‑out: no device is playing, not waiting\n");
+            break;
+        }
+        until = fanout_deadline();          /* a device moved */
+    }
+    pthread_mutex_unlock(&g_fan.lock);
+}
+
+/* A play starts: its onset is taken from the next slot, and a cue the
+   devices may still be playing out gives way to it.  It may run ahead
+   of the devices by ‘queue_ms’ of ‘rate’ × ‘channels’ audio, or
+   FANOUT_BEHIND slots if that is more. */
+static void fanout_begin(unsigned int rate, unsigned int channels,
+                         unsigned int queue_ms)
+{
+    const uint64_t samples = (uint64_t)rate * queue_ms / 1000 * channels;
+    uint64_t lead = (samples + FANOUT_SLOT_SAMPLES - 1) / FANOUT_SLOT_SAMPLES
+                  + 1;                  /* and the end slot */
+    if (lead < FANOUT_BEHIND)
+        lead = FANOUT_BEHIND;
+    if (lead > FANOUT_SLOTS / 2)
+        lead = FANOUT_SLOTS / 2;
+
+    pthread_mutex_lock(&g_fan.lock);
+    g_fan.lead = lead;
+    if (g_fan.unwaited)
+        __atomic_store_n(&g_fan.cut, g_fan.head, __ATOMIC_RELEASE);
+    g_fan.unwaited   = false;
+    g_fan.onset_slot = g_fan.head;
+    __atomic_store_n(&g_fan.onset_ns, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_fan.lock);
+}
+
+static void fanout_publish(const short *buf, size_t frames,
+                           unsigned int rate, unsigned int channels)
+{
+    const uint64_t i = g_fan.head;
+    fanout_wait(fanout_has_room, i);
+
+    FanoutSlot *s = &g_fan.ring[i & (FANOUT_SLOTS - 1)];
+    __atomic_store_n(&s->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->rate     = rate;
+    s->channels = channels;
+    s->frames   = (unsigned int)frames;
+    if (frames)
+        memcpy(s->pcm, buf, frames * channels * sizeof *buf);
+    __atomic_store_n(&s->seq, i + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_fan.head, i + 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&g_fan.lock);
+    pthread_cond_broadcast(&g_fan.data);
+    pthread_mutex_unlock(&g_fan.lock);
+}
+
+/* End of a play: publish the end slot and wait until the fastest
+   device has played it out – or, ‘wait’ false, not at all: the play
+   is queued in the ring, as on a single device it is in the PCM. */
+static void fanout_end(bool wait)
+{
+    const uint64_t end = g_fan.head;
+    fanout_publish(NULL, 0, g_hw.rate, g_hw.channels);
+    if (wait)
+        fanout_wait(fanout_played_out, end);
+    g_fan.unwaited = !wait;
+}
+
+/* ---------- device side (one thread per PCM) ---------- */
+
+/* Slot ‘i’ is not wanted any more: the daemon quits, or a play cut it */
+static bool fanout_cut(uint64_t i)
+{
+    return __atomic_load_n(&g_fan.quit, __ATOMIC_ACQUIRE) ||
+           i < __atomic_load_n(&g_fan.cut, __ATOMIC_ACQUIRE);
+}
+
+static bool fanout_configure(FanoutDevice *d, unsigned int rate,
+                             unsigned int channels)
+{
+    const unsigned int ms = d->adapt.want_ms;
+    if (d->rate == rate && d->channels == channels && d->period_ms == ms)
+        return true;
+
+    snd_pcm_uframes_t period = (snd_pcm_uframes_t)rate * ms / 1000, buffer;
+    d->running = false;
+    if (d->pcm) {
+        snd_pcm_drop(d->pcm);
+        if (!set_hw_params(d->pcm, rate, channels, SND_PCM_FORMAT_S16_LE,
+                           ms, 0, &period, &buffer)) {
+            fprintf(stderr, "fan‑out: %s: cannot play %u Hz x %u\n",
+                    d->name, rate, channels);
+            d->rate = 0;
+            return false;
+        }
+    }
+    d->rate      = rate;
+    d->channels  = channels;
+    d->period_ms = ms;
+    trace_instant(TR_PCM_CONFIG, (int64_t)period, d->name);
+    __atomic_store_n(&d->period_frames, (unsigned long)period,
+                     __ATOMIC_RELAXED);
+    return true;
+}
+
+/* Repeat or drop the first frame of ‘buf’ when the device has drifted;
+   returns the new frame count.  ‘buf’ has room for one more frame. */
+static size_t fanout_correct(FanoutDevice *d, short *buf, size_t frames,
+                             unsigned int ch)
+{
+    if (!d->running || d->writes < FANOUT_SETTLE)
+        return frames;
+
+    const double limit = (double)d->rate * FANOUT_DRIFT_MS / 1000;
+    const double off   = d->err - d->base;
+    if (off > limit) {                          /* fast: hold back */
+        memmove(buf + ch, buf, frames * ch * sizeof *buf);
+        d->base += 1;
+        __atomic_fetch_add(&d->drift_frames, 1, __ATOMIC_RELAXED);
+        return frames + 1;
+    }
+    if (off < -limit && frames > 1) {           /* slow: catch up */
+        memmove(buf, buf + ch, (frames - 1) * ch * sizeof *buf);
+        d->base -= 1;
+        __atomic_fetch_sub(&d->drift_frames, 1, __ATOMIC_RELAXED);
+        return frames - 1;
+    }
+    return frames;
+}
+
+static void fanout_measure(FanoutDevice *d)
+{
+    snd_pcm_sframes_t delay;
+    if (!d->running || snd_pcm_delay(d->pcm, &delay) < 0)
+        return;
+
+    double played = (double)d->written - (double)delay;
+    double expect = (double)(now_ns() - d->t0_ns) * d->rate / 1e9;
+    double err    = played - expect;            /* > 0: device is fast */
+
+    if (++d->writes == 1)
+        d->err = err;
+    else
+        d->err += (err - d->err) / 16;
+    if (d->writes == FANOUT_SETTLE)
+        d->base = d->err;
+}
+
+/* Write slot ‘i’, polling, so that a cut or quit is seen within
+   FANOUT_POLL_MS and what the PCM holds is dropped. */
+static void fanout_write(FanoutDevice *d, uint64_t i, const short *buf,
+                         size_t frames)
+{
+    const unsigned int ch = d->channels;
+    const size_t poll_frames = (size_t)d->rate * FANOUT_POLL_MS / 1000;
+    size_t done = 0;
+
+    trace_begin(TR_PCM_WRITE, (int64_t)frames, d->name);
+    while (done < frames) {
+        if (fanout_cut(i)) {
+            if (d->pcm) {
+                snd_pcm_drop(d->pcm);
+                snd_pcm_prepare(d->pcm);
+            }
+            d->running = false;
+            break;
+        }
+        if (!d->pcm) {                          /* null sink: take the time */
+            size_t n = frames - done < poll_frames ? frames - done
+                                                   : poll_frames;
+            sleep_ns((int64_t)(n * 1000000000ull / d->rate));
+            done += n;
+            continue;
+        }
+
+        snd_pcm_sframes_t rc = snd_pcm_writei(d->pcm, buf + done * ch,
+                                              frames - done);
+        if (rc == -EAGAIN) {                    /* full: wait for room */
+            snd_pcm_wait(d->pcm, FANOUT_POLL_MS);
+            continue;
+        }
+        if (rc == -EPIPE) {                     /* underrun */
+            trace_instant(TR_XRUN, (int64_t)done, d->name);
+            __atomic_fetch_add(&d->underruns, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&g_stats.underruns, 1, __ATOMIC_RELAXED);
+            snd_pcm_prepare(d->pcm);
+            d->running = false;                 /* a new stream starts */
+            continue;
+        }
+        if (rc < 0) {
+            if (snd_pcm_recover(d->pcm, (int)rc, 1) < 0)
+                break;                          /* lose this slot */
+            continue;
+        }
+        if (!d->running) {
+            d->running = true;
+            d->t0_ns   = now_ns();
+            d->written = 0;
+            d->writes  = 0;
+        }
+        d->written += (uint64_t)rc;
+        done += (size_t)rc;
+    }
+    trace_end(TR_PCM_WRITE);
+}
+
+/* End slot ‘i’: let the PCM play out what it holds – by itself, while
+   we poll for a cut – then judge the play for the period policy. */
+static void fanout_drain(FanoutDevice *d, uint64_t i)
+{
+    if (d->pcm && d->rate) {
+        trace_begin(TR_DRAIN, 0, d->name);
+        if (snd_pcm_drain(d->pcm) == -EAGAIN) {
+            while (snd_pcm_state(d->pcm) == SND_PCM_STATE_DRAINING) {
+                if (fanout_cut(i)) {
+                    snd_pcm_drop(d->pcm);
+                    break;
+                }
+                snd_pcm_sframes_t left;
+                int64_t ms = snd_pcm_delay(d->pcm, &left) == 0 && left > 0
+                           ? left * 1000 / d->rate + 1 : 1;
+                sleep_ns((ms < FANOUT_POLL_MS ? ms : FANOUT_POLL_MS)
+                         * 1000000);
+            }
+        }
+        snd_pcm_prepare(d->pcm);
+        trace_end(TR_DRAIN);
+    }
+    d->running = false;
+
+    const unsigned long xruns = __atomic_load_n(&d->underruns,
+                                                __ATOMIC_RELAXED);
+    adapt_update(&d->adapt, xruns - d->xruns_judged, d->name);
+    d->xruns_judged = xruns;
+}
+
+/* Move on to slot ‘tail’ and tell the producer; ‘took’ is the slot
+   just taken, which may be the first of the play. */
+static void fanout_advance(FanoutDevice *d, uint64_t tail, uint64_t took)
+{
+    pthread_mutex_lock(&g_fan.lock);
+    __atomic_store_n(&d->tail, tail, __ATOMIC_RELEASE);
+    if (took == g_fan.onset_slot && !fanout_started(0))
+        __atomic_store_n(&g_fan.onset_ns, now_ns(), __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&g_fan.progress);
+    pthread_mutex_unlock(&g_fan.lock);
+}
+
+static void *fanout_thread(void *arg)
+{
+    FanoutDevice *d = arg;
+    short buf[FANOUT_SLOT_SAMPLES * 2];         /* room for a repeat */
+    uint64_t tail = d->tail;
+
+    while (!__atomic_load_n(&g_fan.quit, __ATOMIC_ACQUIRE)) {
+        if (__atomic_load_n(&d->hold, __ATOMIC_ACQUIRE)) {
+            sleep_ns(FANOUT_POLL_MS * 1000000L);
+            continue;
+        }
+        uint64_t head = __atomic_load_n(&g_fan.head, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            pthread_mutex_lock(&g_fan.lock);
+            while (!g_fan.quit &&
+                   __atomic_load_n(&g_fan.head, __ATOMIC_ACQUIRE) == tail)
+                pthread_cond_wait(&g_fan.data, &g_fan.lock);
+            pthread_mutex_unlock(&g_fan.lock);
+            continue;
+        }
+
+        /* Stalled behind the others, lapped, or cut off by a new play:
+           rejoin the live stream */
+        uint64_t to = tail;
+        const uint64_t fastest = fanout_fastest();
+        const uint64_t cut = __atomic_load_n(&g_fan.cut, __ATOMIC_ACQUIRE);
+        if (fastest > tail + FANOUT_BEHIND)
+            to = fastest;
+        if (head - to >= FANOUT_SLOTS - 1)
+            to = head - FANOUT_SLOTS / 2;
+        if (to < cut)
+            to = cut;
+        if (to != tail) {
+            trace_instant(TR_SKIP, (int64_t)(to - tail), d->name);
+            __atomic_fetch_add(&d->skipped, to - tail, __ATOMIC_RELAXED);
+            tail = to;
+            fanout_advance(d, tail, UINT64_MAX);
+            continue;
+        }
+
+        /* Copy the slot out; a changed sequence means it was overwritten */
+        const FanoutSlot *s = &g_fan.ring[tail & (FANOUT_SLOTS - 1)];
+        if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != tail + 1)
+            continue;
+        const unsigned int rate = s->rate, ch = s->channels;
+        size_t frames = s->frames;
+        if (ch == 0 || frames * ch > FANOUT_SLOT_SAMPLES) {
+            /* not a slot the producer writes – never spin on it */
+            trace_instant(TR_SKIP, 1, d->name);
+            __atomic_fetch_add(&d->skipped, 1, __ATOMIC_RELAXED);
+            tail++;
+            fanout_advance(d, tail, UINT64_MAX);
+            continue;
+        }
+        memcpy(buf, s->pcm, frames * ch * sizeof *buf);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != tail + 1)
+            continue;
+
+        const uint64_t i = tail++;
+        if (frames == 0) {                      /* end of a play */
+            fanout_advance(d, tail, i);
+            fanout_drain(d, i);
+            __atomic_fetch_add(&d->plays, 1, __ATOMIC_RELAXED);
+            pthread_mutex_lock(&g_fan.lock);
+            __atomic_store_n(&d->drained, i + 1, __ATOMIC_RELEASE);
+            pthread_cond_broadcast(&g_fan.progress);
+            pthread_mutex_unlock(&g_fan.lock);
+            continue;
+        }
+        const bool ok = fanout_configure(d, rate, ch);
+        fanout_advance(d, tail, i);
+        if (!ok)
+            continue;
+        frames = fanout_correct(d, buf, frames, ch);
+        fanout_write(d, i, buf, frames);
+        fanout_measure(d);
+    }
+    if (d->pcm)
+        snd_pcm_drop(d->pcm);
+    return NULL;
+}
+
+/* Open the listed PCMs and start their threads; devices that fail to
+   open are left out.  False only if none opens. */
+static bool fanout_open(char names[][64], unsigned int n)
+{
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_fan.progress, &ca);
+    pthread_condattr_destroy(&ca);
+    pthread_cond_init(&g_fan.data, NULL);
+
+    if (!g_adapt.want_ms)
+        adapt_init();
+    g_fan.quit = false;
+    g_fan.stalled_at = UINT64_MAX;
+    for (unsigned int i = 0; i < n; ++i) {
+        FanoutDevice *d = &g_fan.dev[g_fan.ndev];
+        *d = (FanoutDevice){ .tail  = g_fan.head,
+                             .adapt = { .want_ms = g_period_min_ms } };
+        snprintf(d->name, sizeof d->name, "%.*s",
+                 (int)sizeof d->name - 1, names[i]);
+
+        /* the null sink opens nothing – the thread only keeps time */
+        int rc = g_null_sink ? 0
+               : snd_pcm_open(&d->pcm, d->name, SND_PCM_STREAM_PLAYBACK,
+                              SND_PCM_NONBLOCK);
+        if (rc < 0) {
+            fprintf(stderr, "ALSA open error on %s: %s\n", d->name,
+                    snd_strerror(rc));
+            continue;
+        }
+        if (pthread_create(&d->thread, NULL, fanout_thread, d) != 0) {
+            fprintf(stderr, "fan‑out: no thread for %s\n", d->name);
+            if (d->pcm)
+                snd_pcm_close(d->pcm);
+            continue;
+        }
+        g_fan.ndev++;
+    }
+    return g_fan.ndev > 0;
+}
+
+/* Every thread sees ‘quit’ within FANOUT_POLL_MS, whatever its device
+   is doing, and drops what the device still holds – the join does not
+   wait for queued audio. */
+static void fanout_close(void)
+{
+    pthread_mutex_lock(&g_fan.lock);
+    __atomic_store_n(&g_fan.quit, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&g_fan.data);
+    pthread_mutex_unlock(&g_fan.lock);
+
+    for (unsigned int i = 0; i < g_fan.ndev; ++i) {
+        pthread_join(g_fan.dev[i].thread, NULL);
+        if (g_fan.dev[i].pcm)
+            snd_pcm_close(g_fan.dev[i].pcm);
+    }
+    g_fan.ndev = 0;
+}
+
+/* Judge a play on the single device; fan‑out devices judge their own */
+static void adapt_after_play(unsigned long xruns)
+{
+    if (!g_fan.ndev)
+        adapt_update(&g_adapt, xruns, NULL);
+}
+
+/* Bring the PCM to PREPARED for ‘rate’/‘channels’, with a buffer that
+   holds at least ‘queue_ms’ – as far as the device allows – so that a
+   play of that length is queued without blocking.  The HW setup is
+   re‑run only when the format or the adaptive period changed, or the
+   buffer has to grow. */
+static bool pcm_configure(unsigned int rate, unsigned int channels,
+                          unsigned int queue_ms)
 {
-    if (pcm_handle)               /* already opened */
+    if (!g_adapt.want_ms)
+        adapt_init();
+
+    if (g_null_sink || g_fan.ndev) {    /* nothing to configure here */
+        if (g_fan.ndev)
+            fanout_begin(rate, channels, queue_ms);
+        g_hw.rate          = rate;
+        g_hw.channels      = channels;
+        g_hw.period_ms     = g_adapt.want_ms;
+        g_hw.period_frames = g_fan.ndev
+                           ? FANOUT_SLOT_SAMPLES / channels   /* one slot */
+                           : (snd_pcm_uframes_t)rate * g_adapt.want_ms / 1000;
+        g_hw.buffer_frames = g_hw.period_frames * 4;
+        return true;
+    }
+
+    /* A cue may still be playing out its tail (audio_cue_play() does
+       not wait for it); whatever plays next takes the device over. */
+    if (snd_pcm_state(pcm_handle) == SND_PCM_STATE_DRAINING)
+        snd_pcm_drop(pcm_handle);
+
+    if (g_hw.rate == rate && g_hw.channels == channels &&
+        g_hw.period_ms == g_adapt.want_ms && g_hw.queue_ms >= queue_ms) {
+        /* The device may be left in the DRAINING/SETUP state after a
+           previous play – bring it back to PREPARED. */
+        snd_pcm_prepare(pcm_handle);
+        return true;
+    }
+
+    /* once grown for a cue, the buffer stays grown */
+    if (queue_ms < g_hw.queue_ms)
+        queue_ms = g_hw.queue_ms;
+    if (!set_hw_params(pcm_handle, rate, channels, SND_PCM_FORMAT_S16_LE,
+                       g_adapt.want_ms, queue_ms,
+                       &g_hw.period_frames, &g_hw.buffer_frames)) {
+        g_hw.rate = 0;                  /* force a retry next time */
+        return false;
+    }
+    g_hw.rate      = rate;
+    g_hw.channels  = channels;
+    g_hw.period_ms = g_adapt.want_ms;
+    g_hw.queue_ms  = queue_ms;
+    trace_instant(TR_PCM_CONFIG, (int64_t)g_hw.period_frames, NULL);
+    g_stats.period_frames = g_hw.period_frames;
+    g_stats.buffer_frames = g_hw.buffer_frames;
+    return true;
+}
+
+/* Blocking write of ‘frames’ interleaved frames; underruns are counted
+   in both the global stats and ‘*xruns’ and then recovered from. */
+static bool pcm_write_frames(const short *buf, size_t frames,
+                             unsigned int channels, unsigned long *xruns)
+{
+    trace_begin(TR_PCM_WRITE, (int64_t)frames, NULL);
+    if (g_fan.ndev) {                   /* published, paced by the devices */
+        const size_t per = FANOUT_SLOT_SAMPLES / channels;
+        for (size_t off = 0; off < frames; off += per)
+            fanout_publish(buf + off * channels,
+                           frames - off < per ? frames - off : per,
+                           g_hw.rate, channels);
+        trace_end(TR_PCM_WRITE);
         return true;
+    }
+    if (g_null_sink) {
+        trace_end(TR_PCM_WRITE);
+        return true;
+    }
+
+    size_t written = 0;
+    while (written < frames) {
+        int rc = snd_pcm_wait(pcm_handle, 1000);
+        if (rc < 0) {
+            fprintf(stderr, "poll error: %s\n", strerror(-rc));
+            trace_end(TR_PCM_WRITE);
+            return false;
+        }
+
+        rc = snd_pcm_writei(pcm_handle,
+                            buf + written * channels,
+                            frames - written);
+        if (rc == -EPIPE) {               /* underrun */
+            trace_instant(TR_XRUN, (int64_t)written, NULL);
+            g_stats.underruns++;
+            (*xruns)++;
+            snd_pcm_prepare(pcm_handle);
+            continue;
+        }
+        if (rc < 0) {
+            if (snd_pcm_recover(pcm_handle, rc, 0) < 0) {
+                fprintf(stderr, "ALSA write error: %s\n",
+                        snd_strerror(rc));
+                trace_end(TR_PCM_WRITE);
+                return false;
+            }
+            continue;
+        }
+        written += rc;
+    }
+    trace_end(TR_PCM_WRITE);
+    return true;
+}
+
+/* End of one play: let the device(s) play out what was written – and
+   with ‘wait’ false, return while they still do. */
+static void pcm_finish(bool wait)
+{
+    if (g_fan.ndev) {
+        fanout_end(wait);
+    } else if (pcm_handle && wait) {
+        trace_begin(TR_DRAIN, 0, NULL);
+        snd_pcm_drain(pcm_handle);
+        trace_end(TR_DRAIN);
+    } else if (pcm_handle) {
+        /* ‑EAGAIN at once; the device drains by itself, then stops */
+        snd_pcm_nonblock(pcm_handle, 1);
+        snd_pcm_drain(pcm_handle);
+        snd_pcm_nonblock(pcm_handle, 0);
+    }
+}
+
+/* When the play's first frames reached a device: now, right after the
+   first write – or, fanned out, when a device took the first slot,
+   which may not have happened yet. */
+static int64_t pcm_onset_ns(void)
+{
+    if (!g_fan.ndev)
+        return now_ns();
+    fanout_wait(fanout_started, 0);
+    const int64_t t = __atomic_load_n(&g_fan.onset_ns, __ATOMIC_ACQUIRE);
+    return t ? t : now_ns();
+}
+
+/*=====================================================================
+ *  PUBLIC API – initialisation / clean‑up
+ *
+ *  Opening a device can take a while (probing, a USB DAC waking up), so
+ *  audio_init_async() does it on a thread of its own; audio_init() –
+ *  which every play calls first – waits for that thread, so only the
+ *  first play ever waits, and only for what is left of the open.
+ *====================================================================*/
+static pthread_t g_open_thread;
+static bool      g_open_pending = false;   /* started, not yet joined */
+static bool      g_open_done    = false;   /* set by the thread, atomic */
+
+static bool audio_open(void)
+{
+    if (pcm_handle || g_fan.ndev)
+        return true;                /* already opened */
+
+    /* CABATA_DEVICES: PCM names separated by blanks */
+    char names[AUDIO_MAX_DEVICES][64];
+    unsigned int n = 0;
+    const char *list = getenv("CABATA_DEVICES");
+    while (list && *list && n < AUDIO_MAX_DEVICES) {
+        list += strspn(list, " \t");
+        size_t len = strcspn(list, " \t");
+        if (len && len < sizeof names[n]) {
+            snprintf(names[n], sizeof names[n], "%.*s", (int)len, list);
+            n++;
+        }
+        list += len;
+    }
+    if (n > 1)
+        return fanout_open(names, n);   /* null sink: without PCMs */
+    if (g_null_sink)
+        return true;                    /* nothing to open */
 
-    int rc = snd_pcm_open(&pcm_handle, "default",
+    int rc = snd_pcm_open(&pcm_handle, n ? names[0] : "default",
                           SND_PCM_STREAM_PLAYBACK, 0);
     if (rc < 0) {
         fprintf(stderr, "ALSA open error: %s\n", snd_strerror(rc));
@@ -164,29 +993,83 @@ bool audio_init(void)
     return true;
 }
 
+static void *open_thread(void *arg)
+{
+    (void)arg;
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    trace_begin(TR_OPEN, 0, NULL);
+    audio_open();
+    trace_end(TR_OPEN);
+    g_stats.open_us = elapsed_us(&t0);
+    __atomic_store_n(&g_open_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+bool audio_init_async(void)
+{
+    if (g_open_pending)
+        return true;
+    if (pthread_create(&g_open_thread, NULL, open_thread, NULL) != 0)
+        return audio_open();        /* no thread – open right here */
+    g_open_pending = true;
+    return true;
+}
+
+/* Join the background open, if one is running */
+static void open_wait(void)
+{
+    if (!g_open_pending)
+        return;
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_join(g_open_thread, NULL);
+    g_open_pending = false;
+    g_stats.open_wait_us = elapsed_us(&t0);
+}
+
+/* True once nothing is opening any more – joins a thread that is done,
+   never waits for one that is not.  Stats readers use it. */
+static bool open_settled(void)
+{
+    if (g_open_pending && __atomic_load_n(&g_open_done, __ATOMIC_ACQUIRE))
+        open_wait();
+    return !g_open_pending;
+}
+
+bool audio_init(void)
+{
+    open_wait();
+    return audio_open();            /* retries if the first open failed */
+}
+
 /* audio_cleanup() is already present at the bottom of the file */
 
 /*=====================================================================
  *  PLAY‑QUEUE – internal helpers
  *====================================================================*/
-/* Grow the internal buffer so it can hold at least ‘need’ frames. */
-static bool chain_ensure_capacity(size_t need)
+/* Grow the chain's buffer so it can hold at least ‘need’ samples. */
+static bool chain_ensure_capacity(AudioChain *c, size_t need)
 {
-    if (need <= g_chain.capacity_frames)
+    if (need <= c->capacity)
         return true;
 
-    size_t new_cap = g_chain.capacity_frames ? g_chain.capacity_frames : 64;
+    size_t new_cap = c->capacity ? c->capacity : 64;
     while (new_cap < need)
         new_cap *= 2;                     /* exponential growth */
 
-    short *new_buf = realloc(g_chain.buf,
-                             new_cap * g_chain.channels * sizeof *new_buf);
+    short *new_buf = realloc(c->buf, new_cap * sizeof *new_buf);
     if (!new_buf) {
         perror("realloc");
         return false;
     }
-    g_chain.buf = new_buf;
-    g_chain.capacity_frames = new_cap;
+    c->buf = new_buf;
+    c->capacity = new_cap;
+
+    /* Real‑time mode without mlockall(): pin the buffers one by one */
+    if (g_stats.mem_locked && !g_stats.mem_locked_all &&
+        mlock(new_buf, new_cap * sizeof *new_buf) != 0)
+        g_stats.mem_locked = false;       /* no longer all of them */
     return true;
 }
 
@@ -196,113 +1079,185 @@ static bool chain_ensure_capacity(size_t need)
 bool audio_chain_init(void)
 {
     /* Reset the queue – keep any already‑allocated buffer so that a
-       subsequent add can reuse it without another malloc. */
+       subsequent add can reuse it without another malloc – and make
+       sure both chains start out with their full reserve. */
     g_chain.frames   = 0;
     g_chain.rate     = 0;
     g_chain.channels = 0;
-    return true;
+    return chain_ensure_capacity(&g_chain,  CHAIN_RESERVE_SAMPLES) &&
+           chain_ensure_capacity(&g_staged, CHAIN_RESERVE_SAMPLES);
 }
 
 void audio_chain_cleanup(void)
 {
-    if (g_chain.buf) {
-        free(g_chain.buf);
-        g_chain.buf = NULL;
-    }
-    g_chain.capacity_frames = 0;
-    g_chain.frames   = 0;
-    g_chain.rate     = 0;
-    g_chain.channels = 0;
+    chain_clear_segments(&g_chain);
+    chain_clear_segments(&g_staged);
+    free(g_chain.buf);
+    free(g_staged.buf);
+    g_chain  = (AudioChain){ 0 };
+    g_staged = (AudioChain){ 0 };
+    g_target = &g_chain;
 
     audio_cleanup();            /* close ALSA if it was opened */
 }
 
-/* Add a raw wav buffer (memory + length) to the chain. */
-bool audio_chain_add(const unsigned char *wav_buf,
-                     sf_count_t wav_len)
+/* Add parsed 16‑bit PCM (an asset's or a cached phrase's) to the chain. */
+static bool chain_add_wav(const WavInfo *w, bool low_prio)
 {
-    SF_INFO sfinfo = {0};
-
-    /* open the wav from memory */
-    SNDFILE *sf = sf_open_mem(wav_buf, wav_len, &sfinfo);
-    if (!sf) {
-        fprintf(stderr, "libsndfile: %s\n", sf_strerror(NULL));
-        return false;
-    }
-
-    /* sanity check – we only support 16‑bit PCM WAV */
-    if ((sfinfo.format & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV ||
-        (sfinfo.format & SF_FORMAT_SUBMASK) != SF_FORMAT_PCM_16) {
-        fprintf(stderr,
-                "Unsupported WAV (need 16‑bit PCM, got 0x%08x)\n",
-                sfinfo.format);
-        sf_close(sf);
-        return false;
-    }
+    AudioChain *c = g_target;
+    const WavInfo wav = *w;
 
     /* -------------------------------------------------------------
      *  Verify that the new segment matches the already‑queued format,
      *  or initialise the queue if this is the first segment.
      * ------------------------------------------------------------- */
-    if (g_chain.frames == 0) {
-        g_chain.rate     = sfinfo.samplerate;
-        g_chain.channels = sfinfo.channels;
-    } else if (g_chain.rate != (unsigned)sfinfo.samplerate ||
-               g_chain.channels != (unsigned)sfinfo.channels) {
+    if (chain_empty(c)) {
+        c->rate     = wav.rate;
+        c->channels = wav.channels;
+        clock_gettime(CLOCK_MONOTONIC, &c->t_start);
+    } else if (c->rate != wav.rate || c->channels != wav.channels) {
         fprintf(stderr,
-                "audio_chain_add: format mismatch (queue %u Hz %u‑ch, "
-                "segment %u Hz %u‑ch)\n",
-                g_chain.rate, g_chain.channels,
-                (unsigned)sfinfo.samplerate, (unsigned)sfinfo.channels);
-        sf_close(sf);
+                "audio_chain_add: format mismatch (queue %u Hz %u‑ch, "
+                "segment %u Hz %u‑ch)\n",
+                c->rate, c->channels, wav.rate, wav.channels);
         return false;
     }
 
     /* -------------------------------------------------------------
-     *  Make sure the internal buffer is big enough and read the data.
+     *  Streaming: remember where the samples are and copy them at
+     *  play time.  Staged chains are always copied – that is their
+     *  whole point.
      * ------------------------------------------------------------- */
-    size_t new_total = g_chain.frames + (size_t)sfinfo.frames;
-    if (!chain_ensure_capacity(new_total))
-    {
-        sf_close(sf);
-        return false;
+    bool streamed = c->nseg > 0 && c->seg[c->nseg - 1].pcm != NULL;
+    if (g_streaming && c == &g_chain && c->nseg < CHAIN_MAX_SEGMENTS) {
+        c->seg[c->nseg++] = (ChainSegment){ .pcm = wav.pcm,
+                                            .frames = wav.frames,
+                                            .low_prio = low_prio };
+        return true;
     }
 
-    /* Read directly into the tail of the buffer */
-    sf_count_t got = sf_readf_short(sf,
-                                    g_chain.buf +
-                                    g_chain.frames * g_chain.channels,
-                                    sfinfo.frames);
-    if (got != sfinfo.frames) {
-        fprintf(stderr,
-                "short read: wanted %lld, got %lld\n",
-                (long long)sfinfo.frames,
-                (long long)got);
-        sf_close(sf);
+    /* Copied segments must not overtake streamed ones */
+    if (streamed) {
+        fprintf(stderr, "audio_chain_add: too many streamed segments\n");
         return false;
     }
 
-    g_chain.frames = new_total;
-    sf_close(sf);
+    /* -------------------------------------------------------------
+     *  Make sure the internal buffer is big enough and copy the data
+     *  directly into its tail.
+     * ------------------------------------------------------------- */
+    size_t new_total = c->frames + wav.frames;
+    if (!chain_ensure_capacity(c, new_total * c->channels))
+        return false;
+
+    wav_copy_s16(c->buf + c->frames * c->channels, wav.pcm,
+                 wav.frames * c->channels);
+    c->frames = new_total;
+
+    /* Past CHAIN_MAX_SEGMENTS, further clips extend the last segment
+       (no fade at those joins) rather than failing the announcement. */
+    if (c->nseg < CHAIN_MAX_SEGMENTS)
+        c->seg[c->nseg++] = (ChainSegment){ .pcm = NULL,
+                                            .frames = wav.frames,
+                                            .low_prio = low_prio };
+    else
+        c->seg[c->nseg - 1].frames += wav.frames;
     return true;
 }
 
+/* Add a raw wav buffer (memory + length) to the chain. */
+static bool chain_add(const unsigned char *wav_buf,
+                      size_t wav_len,
+                      bool low_prio)
+{
+    WavInfo wav;
+
+    /* parse the header in place – we only support 16‑bit PCM WAV */
+    if (!wav_parse(wav_buf, wav_len, &wav)) {
+        fprintf(stderr, "Unsupported WAV (need 16‑bit PCM)\n");
+        return false;
+    }
+    return chain_add_wav(&wav, low_prio);
+}
+
+bool audio_chain_add(const unsigned char *wav_buf,
+                     size_t wav_len)
+{
+    trace_begin(TR_CHAIN_ADD, (int64_t)wav_len, NULL);
+    bool ok = chain_add(wav_buf, wav_len, false);
+    trace_end(TR_CHAIN_ADD);
+    return ok;
+}
+
 /* Convenience wrapper for an embedded asset. */
 bool audio_chain_add_by_name(const char *name)
 {
-    const EmbeddedWav e = get_embedded_wav(name);
+    const EmbeddedWav e = asset_get(name);
+    if (!e.data) {
+        fprintf(stderr, "Embedded wav not found: %s\n", name);
+        return false;
+    }
+
+    trace_begin(TR_CHAIN_ADD, (int64_t)e.size, name);
+    bool ok = chain_add(e.data, e.size, false);
+    trace_end(TR_CHAIN_ADD);
+    return ok;
+}
+
+bool audio_chain_add_by_name_prio(const char *name, AudioPriority prio)
+{
+    const EmbeddedWav e = asset_get(name);
     if (!e.data) {
         fprintf(stderr, "Embedded wav not found: %s\n", name);
         return false;
     }
 
-    return audio_chain_add(e.data, e.size);
+    trace_begin(TR_CHAIN_ADD, (int64_t)e.size, name);
+    bool ok = chain_add(e.data, e.size, prio == AUDIO_PRIO_LOW);
+    trace_end(TR_CHAIN_ADD);
+    return ok;
+}
+
+/* -----------------------------------------------------------------
+ *  Staging – the look‑ahead announcement is decoded into g_staged
+ *  while the current phase runs; using it is a pointer swap.
+ * ----------------------------------------------------------------- */
+void audio_chain_stage_begin(void)
+{
+    chain_clear_segments(&g_staged);
+    g_staged.frames = 0;
+    g_target = &g_staged;
+}
+
+void audio_chain_stage_end(void)
+{
+    g_target = &g_chain;
+}
+
+bool audio_chain_use_staged(void)
+{
+    if (chain_empty(&g_staged))
+        return false;
+
+    /* Swap rather than copy – the old chain buffer becomes the next
+       staging buffer, so neither side reallocates once warmed up. */
+    chain_clear_segments(&g_chain);
+    AudioChain tmp = g_chain;
+    g_chain  = g_staged;
+    g_staged = tmp;
+    g_staged.frames = 0;
+    g_staged.nseg   = 0;
+
+    /* The announcement starts now, not when it was staged */
+    clock_gettime(CLOCK_MONOTONIC, &g_chain.t_start);
+    return true;
 }
 
 /* Reset the queue – keep the allocated buffer so that a later add does
    not need to realloc. */
 void audio_chain_reset(void)
 {
+    chain_clear_segments(&g_chain);
     g_chain.frames = 0;
     /* rate & channels stay as‑is; they will be re‑checked on the next
        add. */
@@ -318,223 +1273,508 @@ bool audio_chain_play(void)
             return false;
     }
 
-    if (g_chain.frames == 0) {
+    g_last_ttfs_us = 0;
+    if (chain_empty(&g_chain)) {
         /* nothing to do – but the call is not an error */
         return true;
     }
 
     /* -------------------------------------------------------------
-     *  (re)configure hardware parameters – only when they differ from
-     *  the current ALSA configuration.
+     *  (re)configure hardware parameters – only when the format or the
+     *  adaptive period differ from the current ALSA configuration.
      * ------------------------------------------------------------- */
-    static unsigned int cur_rate = 0, cur_chan = 0;
-    static snd_pcm_uframes_t period_frames = 0;
-    static snd_pcm_uframes_t buffer_frames = 0;
-
-    if (!cur_rate ||
-        cur_rate != g_chain.rate ||
-        cur_chan != g_chain.channels) {
-
-        if (!set_hw_params(pcm_handle,
-                           g_chain.rate,
-                           g_chain.channels,
-                           SND_PCM_FORMAT_S16_LE,
-                           &period_frames,
-                           &buffer_frames)) {
-            return false;
-        }
-        cur_rate = g_chain.rate;
-        cur_chan = g_chain.channels;
-    } else {
-        /* The device may be left in the DRAINING/SETUP state after a
-           previous play – bring it back to PREPARED. */
-        snd_pcm_prepare(pcm_handle);
-    }
+    if (!pcm_configure(g_chain.rate, g_chain.channels, 0))
+        return false;
 
     /* -------------------------------------------------------------
-     *  Playback loop – walk the already‑filled buffer in period‑size
-     *  chunks.
+     *  Playback loop – one period at a time, segment by segment.  Each
+     *  period is copied from the chain buffer (or, streamed, from the
+     *  asset) into the period buffer, run through the DSP stage and
+     *  written.
      * ------------------------------------------------------------- */
-    size_t frames_left = g_chain.frames;
+    const unsigned int ch = g_chain.channels;
+    size_t period = g_hw.period_frames;
+    if (period > period_buf_frames(ch))
+        period = period_buf_frames(ch);
+
+    const DspParams dsp = dsp_params(g_chain.rate);
     const short *src = g_chain.buf;
+    short *out = g_period_buf;
+    unsigned long xruns = 0;
+
+    for (size_t i = 0; i < g_chain.nseg; ++i) {
+        const ChainSegment *sg = &g_chain.seg[i];
+        size_t off = 0;
 
-    while (frames_left > 0) {
-        snd_pcm_uframes_t chunk = period_frames;
-        if (chunk > frames_left)
-            chunk = frames_left;
+        while (off < sg->frames) {
+            size_t chunk = period;
+            if (chunk > sg->frames - off)
+                chunk = sg->frames - off;
 
-        size_t written = 0;
-        while (written < chunk) {
-            int rc = snd_pcm_wait(pcm_handle, 1000);
-            if (rc < 0) {
-                fprintf(stderr, "poll error: %s\n", strerror(-rc));
+            if (sg->pcm)
+                wav_copy_s16(out, sg->pcm + off * ch * 2, chunk * ch);
+            else
+                memcpy(out, src + off * ch, chunk * ch * sizeof *out);
+            dsp_segment_apply(&dsp, sg->low_prio, out, chunk, ch,
+                              off, sg->frames);
+
+            if (!pcm_write_frames(out, chunk, ch, &xruns))
                 return false;
-            }
+            if (!g_last_ttfs_us)
+                g_last_ttfs_us = us_until(&g_chain.t_start, pcm_onset_ns());
 
-            rc = snd_pcm_writei(pcm_handle,
-                               src + written * g_chain.channels,
-                               chunk - written);
-            if (rc == -EPIPE) {               /* underrun */
-                snd_pcm_prepare(pcm_handle);
-                continue;
-            }
-            if (rc < 0) {
-                if (snd_pcm_recover(pcm_handle, rc, 0) < 0) {
-                    fprintf(stderr, "ALSA write error: %s\n",
-                            snd_strerror(rc));
-                    return false;
-                }
-                continue;
-            }
-            written += rc;
+            off += chunk;
         }
-
-        src          += chunk * g_chain.channels;
-        frames_left  -= chunk;
+        if (!sg->pcm)
+            src += sg->frames * ch;
     }
 
     /* -------------------------------------------------------------
      *  Finish cleanly.
      * ------------------------------------------------------------- */
-    snd_pcm_drain(pcm_handle);   /* let the last frames finish playing */
+    pcm_finish(true);   /* let the last frames finish playing */
+    adapt_after_play(xruns);
     return true;
 }
 
-/* --------------------------------------------------------------- */
-void audio_cleanup(void)
+void audio_chain_set_streaming(bool on)
 {
-    if (pcm_handle) {
-        snd_pcm_close(pcm_handle);
-        pcm_handle = NULL;
-    }
+    g_streaming = on;
 }
 
-bool play_embedded_wav_by_name(const char *name)
+void audio_set_null_sink(bool on)
 {
-    const EmbeddedWav e = get_embedded_wav(name);
-    if (!e.data) {
-        fprintf(stderr, "Embedded wav not found: %s\n", name);
+    g_null_sink = on;
+}
+
+unsigned long audio_chain_last_ttfs_us(void)
+{
+    return g_last_ttfs_us;
+}
+
+void audio_set_dsp(unsigned int gain_pct, unsigned int duck_pct,
+                   unsigned int fade_ms)
+{
+    int64_t g = (int64_t)gain_pct * DSP_UNITY / 100;
+    int64_t d = (int64_t)duck_pct * DSP_UNITY / 100;
+    g_gain_q15 = (int32_t)(g > DSP_GAIN_MAX ? DSP_GAIN_MAX : g);
+    g_duck_q15 = (int32_t)(d > DSP_UNITY ? DSP_UNITY : d);
+    g_fade_ms  = fade_ms;
+}
+
+/*=====================================================================
+ *  PUBLIC API – countdown cues
+ *
+ *  An asset that starts with 100 ms of silence is heard 100 ms late,
+ *  so only the word itself, plus a short lead‑in and tail, is kept.
+ *====================================================================*/
+#define CUE_POOL_SAMPLES  (48000 * 2 * 2)   /* 2 s of 48 kHz stereo   */
+#define CUE_SILENCE       328               /* about ‑40 dBFS         */
+#define CUE_LEAD_MS       10
+#define CUE_TAIL_MS       30
+
+typedef struct {
+    size_t       off;                       /* first sample in the pool */
+    size_t       frames;
+    unsigned int rate, channels;
+} Cue;
+
+static short        g_cue_pool[CUE_POOL_SAMPLES];
+static Cue          g_cues[AUDIO_CUE_SLOTS];
+static unsigned int g_ncues = 0;
+
+/* Above the silence floor – trims cues here and phrase parts below */
+static bool sample_loud(int v)
+{
+    return v > CUE_SILENCE || v < -CUE_SILENCE;
+}
+
+static bool cue_loud(const short *frame, unsigned int channels)
+{
+    for (unsigned int c = 0; c < channels; ++c)
+        if (sample_loud(frame[c]))
+            return true;
+    return false;
+}
+
+/* Load one asset at sample ‘used’ of the pool, trimmed in place */
+static bool cue_load(Cue *q, const char *name, size_t used)
+{
+    const EmbeddedWav e = asset_get(name);
+    WavInfo wav;
+    if (!e.data || !wav_parse(e.data, e.size, &wav)) {
+        fprintf(stderr, "Cue %s: missing or not 16‑bit PCM\n", name);
         return false;
     }
-
-    /* ---------- open the wav from memory with libsndfile ---------- */
-    SF_INFO sfinfo = {0};
-    static const SF_VIRTUAL_IO vio = {
-        .get_filelen = mem_length,
-        .seek        = mem_seek,
-        .read        = mem_read,
-        .write       = NULL,
-        .tell        = mem_tell
-    };
-    MemFile *mf = malloc(sizeof *mf);
-    if (!mf) { perror("malloc"); return false; }
-    mf->data = e.data;
-    mf->size = e.size;
-    mf->pos  = 0;
-
-    SNDFILE *sf = sf_open_virtual(&vio, SFM_READ, &sfinfo, mf);
-    if (!sf) {
-        fprintf(stderr, "libsndfile: %s: %s\n",
-                name, sf_strerror(NULL));
-        free(mf);
+    const unsigned int ch = wav.channels;
+    if (wav.frames * ch > CUE_POOL_SAMPLES - used) {
+        fprintf(stderr, "Cue %s: out of cue memory\n", name);
         return false;
     }
 
-    /* ---------- sanity check ---------- */
-    if ((sfinfo.format & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV ||
-        (sfinfo.format & SF_FORMAT_SUBMASK) != SF_FORMAT_PCM_16) {
-        fprintf(stderr,
-                "Unsupported WAV (need 16‑bit PCM, got 0x%08x)\n",
-                sfinfo.format);
-        sf_close(sf);          /* frees mf */
+    short *s = g_cue_pool + used;
+    wav_copy_s16(s, wav.pcm, wav.frames * ch);
+
+    size_t first = 0, end = wav.frames;
+    while (first < end && !cue_loud(s + first * ch, ch))
+        first++;
+    while (end > first && !cue_loud(s + (end - 1) * ch, ch))
+        end--;
+    const size_t lead = (size_t)wav.rate * CUE_LEAD_MS / 1000;
+    const size_t tail = (size_t)wav.rate * CUE_TAIL_MS / 1000;
+    first = first > lead ? first - lead : 0;
+    end   = end + tail < wav.frames ? end + tail : wav.frames;
+
+    if ((end - first) * 1000 / wav.rate > AUDIO_CUE_MAX_MS) {
+        fprintf(stderr, "Cue %s: %zu ms, longer than %d ms\n", name,
+                (end - first) * 1000 / wav.rate, AUDIO_CUE_MAX_MS);
         return false;
     }
+    memmove(s, s + first * ch, (end - first) * ch * sizeof *s);
 
-    /* ---------- open ALSA if we haven’t already ---------- */
-    if (!pcm_handle) {
-        int rc = snd_pcm_open(&pcm_handle, "default",
-                              SND_PCM_STREAM_PLAYBACK, 0);
-        if (rc < 0) {
-            fprintf(stderr, "ALSA open error: %s\n", snd_strerror(rc));
-            sf_close(sf);
+    *q = (Cue){ .off = used, .frames = end - first,
+                .rate = wav.rate, .channels = ch };
+    return true;
+}
+
+bool audio_cues_load(const char *const *names, unsigned int n)
+{
+    g_ncues = 0;
+    if (n > AUDIO_CUE_SLOTS)
+        return false;
+
+    size_t used = 0;
+    for (unsigned int i = 0; i < n; ++i) {
+        if (!cue_load(&g_cues[i], names[i], used))
             return false;
+        used += g_cues[i].frames * g_cues[i].channels;
+    }
+    g_ncues = n;
+    return true;
+}
+
+bool audio_cue_play(unsigned int slot, AudioCueTiming *t)
+{
+    if (slot >= g_ncues)
+        return false;
+    const Cue *q = &g_cues[slot];
+    const unsigned int ch = q->channels;
+
+    /* The buffer takes the whole cue, so no write below blocks */
+    if (!audio_init() || !pcm_configure(q->rate, ch, AUDIO_CUE_MAX_MS))
+        return false;
+
+    trace_begin(TR_CUE, slot, NULL);
+    size_t period = g_hw.period_frames;
+    if (period > period_buf_frames(ch))
+        period = period_buf_frames(ch);
+
+    const DspParams dsp = dsp_params(q->rate);
+    const short *src = g_cue_pool + q->off;
+    short *buf = g_period_buf;
+    unsigned long xruns = 0;
+    bool ok = true;
+
+    t->onset_ns = 0;
+    for (size_t off = 0; off < q->frames; off += period) {
+        size_t chunk = q->frames - off < period ? q->frames - off : period;
+        memcpy(buf, src + off * ch, chunk * ch * sizeof *buf);
+        dsp_segment_apply(&dsp, false, buf, chunk, ch, off, q->frames);
+        if (!pcm_write_frames(buf, chunk, ch, &xruns)) {
+            ok = false;
+            break;
         }
+        if (!t->onset_ns)
+            t->onset_ns = pcm_onset_ns();
     }
+    t->end_ns = t->onset_ns +
+                (int64_t)(q->frames * 1000000000ull / q->rate);
 
-    /* ---------- (re)configure HW parameters only when they change ---------- */
-    static unsigned int cur_rate = 0, cur_chan = 0;
-    static snd_pcm_uframes_t period_frames = 0;
-    static snd_pcm_uframes_t buffer_frames = 0;
-
-    if (!cur_rate ||
-        cur_rate != sfinfo.samplerate ||
-        cur_chan != sfinfo.channels) {
-
-        if (!set_hw_params(pcm_handle,
-                           sfinfo.samplerate,
-                           sfinfo.channels,
-                           SND_PCM_FORMAT_S16_LE,
-                           &period_frames,
-                           &buffer_frames)) {
-            sf_close(sf);
+    /* Do not wait for the tail – the device plays it by itself */
+    if (ok)
+        pcm_finish(false);
+    adapt_after_play(xruns);
+    trace_end(TR_CUE);
+    return ok;
+}
+
+/*=====================================================================
+ *  PUBLIC API – phrase cache
+ *
+ *  Joined as they come, the parts of a composed number each bring
+ *  their own lead‑in and tail silence.  A phrase is composed once,
+ *  with the silence at every join cut down to a word gap, into a slot
+ *  of a static pool; after that it is one segment, added like any
+ *  built‑in asset.  The least recently used slot is reused, so a slot
+ *  a streamed chain still points into is never the one taken – unless
+ *  a single announcement used more than PHRASE_SLOTS phrases.
+ *====================================================================*/
+#define PHRASE_SLOTS        12
+#define PHRASE_MAX_BYTES    (16000 * 6 * 2)   /* 6 s of the 16 kHz voice */
+#define PHRASE_KEY_MAX      64
+#define PHRASE_LEAD_MS      20                /* kept before a word…     */
+#define PHRASE_TAIL_MS      60                /* …and after one          */
+
+typedef struct {
+    char          key[PHRASE_KEY_MAX];   /* the parts, blank‑separated  */
+    unsigned long used;                  /* g_phrase_clock at last use  */
+    WavInfo       wav;                   /* .pcm points into ‘pcm’      */
+    unsigned char pcm[PHRASE_MAX_BYTES]; /* S16‑LE, as inside an asset  */
+} Phrase;
+
+static Phrase        g_phrases[PHRASE_SLOTS];
+static unsigned long g_phrase_clock = 0;
+
+static bool pcm_loud(const unsigned char *frame, unsigned int channels)
+{
+    for (unsigned int c = 0; c < channels; ++c)
+        if (sample_loud((int16_t)(frame[2 * c] | frame[2 * c + 1] << 8)))
+            return true;
+    return false;
+}
+
+/* Join the assets ‘parts[0..n)’ into ‘p’; false if one is missing, the
+   formats differ or the result does not fit. */
+static bool phrase_compose(Phrase *p, const char *const *parts,
+                           unsigned int n)
+{
+    size_t bytes = 0;
+    for (unsigned int i = 0; i < n; ++i) {
+        const EmbeddedWav e = asset_get(parts[i]);
+        WavInfo w;
+        if (!e.data || !wav_parse(e.data, e.size, &w))
+            return false;
+        if (i == 0) {
+            p->wav.rate     = w.rate;
+            p->wav.channels = w.channels;
+        } else if (w.rate != p->wav.rate || w.channels != p->wav.channels) {
             return false;
         }
-        cur_rate = sfinfo.samplerate;
-        cur_chan = sfinfo.channels;
+
+        const unsigned int ch = w.channels;
+        const size_t fb = 2 * ch;                /* bytes per frame */
+        size_t first = 0, end = w.frames;
+        if (i > 0) {
+            const size_t lead = (size_t)w.rate * PHRASE_LEAD_MS / 1000;
+            while (first < end && !pcm_loud(w.pcm + first * fb, ch))
+                first++;
+            first = first > lead ? first - lead : 0;
+        }
+        if (i + 1 < n) {
+            const size_t tail = (size_t)w.rate * PHRASE_TAIL_MS / 1000;
+            while (end > first && !pcm_loud(w.pcm + (end - 1) * fb, ch))
+                end--;
+            end = end + tail < w.frames ? end + tail : w.frames;
+        }
+
+        const size_t len = (end - first) * fb;
+        if (len > sizeof p->pcm - bytes)
+            return false;
+        memcpy(p->pcm + bytes, w.pcm + first * fb, len);
+        bytes += len;
+    }
+    p->wav.frames = bytes / (2 * p->wav.channels);
+    p->wav.pcm    = p->pcm;
+    return true;
+}
+
+static bool add_parts(const char *const *parts, unsigned int n)
+{
+    bool ok = true;
+    for (unsigned int i = 0; i < n; ++i)
+        ok = audio_chain_add_by_name(parts[i]) && ok;
+    return ok;
+}
+
+bool audio_chain_add_phrase(const char *const *parts, unsigned int n)
+{
+    if (n == 1)
+        return audio_chain_add_by_name(parts[0]);
+
+    char key[PHRASE_KEY_MAX];
+    size_t len = 0;
+    for (unsigned int i = 0; i < n; ++i) {
+        int w = snprintf(key + len, sizeof key - len, "%s%s",
+                         i ? " " : "", parts[i]);
+        if (w < 0 || (size_t)w >= sizeof key - len)
+            return add_parts(parts, n);      /* too long to cache */
+        len += (size_t)w;
+    }
+
+    Phrase *p = NULL, *lru = &g_phrases[0];
+    for (unsigned int i = 0; i < PHRASE_SLOTS && !p; ++i) {
+        if (strcmp(g_phrases[i].key, key) == 0)
+            p = &g_phrases[i];
+        else if (g_phrases[i].used < lru->used)
+            lru = &g_phrases[i];
+    }
+    if (p) {
+        g_stats.phrase_hits++;
     } else {
-        /* The device is still in the *prepared* state from the previous
-         * playback, but after a call to snd_pcm_drain() it is no longer
-         * ready.  Bring it back to the prepared state. */
-        snd_pcm_prepare(pcm_handle);
+        g_stats.phrase_misses++;
+        p = lru;
+        p->key[0] = '\0';
+        if (!phrase_compose(p, parts, n))
+            return add_parts(parts, n);
+        memcpy(p->key, key, len + 1);
+    }
+    p->used = ++g_phrase_clock;
+
+    trace_begin(TR_CHAIN_ADD, (int64_t)(p->wav.frames * 2 * p->wav.channels),
+                key);
+    bool ok = chain_add_wav(&p->wav, false);
+    trace_end(TR_CHAIN_ADD);
+    return ok;
+}
+
+void audio_phrases_flush(void)
+{
+    for (unsigned int i = 0; i < PHRASE_SLOTS; ++i)
+        g_phrases[i].key[0] = '\0';
+}
+
+/*=====================================================================
+ *  PUBLIC API – real‑time mode
+ *====================================================================*/
+bool audio_rt_enable(int priority)
+{
+    /* ---------- scheduling: SCHED_FIFO, else the best nice we may ---------- */
+    struct sched_param sp = { .sched_priority = priority };
+    if (sched_setscheduler(0, SCHED_FIFO, &sp) == 0) {
+        g_stats.rt_sched = true;
+    } else {
+        fprintf(stderr, "SCHED_FIFO %d unavailable (%s), trying nice\n",
+                priority, strerror(errno));
+        if (setpriority(PRIO_PROCESS, 0, -10) == -1)
+            fprintf(stderr, "nice -10 unavailable (%s)\n", strerror(errno));
+    }
+    /* the fan‑out writers are the playback path too; ones still being
+       opened in the background inherit the policy instead */
+    for (unsigned int i = 0; g_stats.rt_sched && open_settled() &&
+                             i < g_fan.ndev; ++i)
+        pthread_setschedparam(g_fan.dev[i].thread, SCHED_FIFO, &sp);
+
+    /* ---------- memory: everything, else just the playback buffers ---------- */
+    bool locked = true;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        g_stats.mem_locked_all = true;
+    } else {
+        fprintf(stderr, "mlockall failed (%s), locking buffers only\n",
+                strerror(errno));
+        if (g_chain.buf)
+            locked &= mlock(g_chain.buf,
+                            g_chain.capacity * sizeof *g_chain.buf) == 0;
+        if (g_staged.buf)
+            locked &= mlock(g_staged.buf,
+                            g_staged.capacity * sizeof *g_staged.buf) == 0;
+        locked &= mlock(g_period_buf, sizeof g_period_buf) == 0;
+        locked &= mlock(g_cue_pool, sizeof g_cue_pool) == 0;
+        locked &= mlock(g_phrases, sizeof g_phrases) == 0;
+        if (!locked)
+            fprintf(stderr, "mlock failed (%s), memory not locked\n",
+                    strerror(errno));
+        asset_pack_set_locked(locked);
+    }
+    /* "buffers" in stats only when every one of them is locked */
+    g_stats.mem_locked = locked;
+
+    return g_stats.rt_sched;
+}
+
+void audio_get_stats(AudioStats *out)
+{
+    if (!open_settled())                /* the thread still writes them */
+        *out = (AudioStats){ .rt_sched       = g_stats.rt_sched,
+                             .mem_locked     = g_stats.mem_locked,
+                             .mem_locked_all = g_stats.mem_locked_all };
+    else
+        *out = g_stats;
+    out->underruns = __atomic_load_n(&g_stats.underruns, __ATOMIC_RELAXED);
+}
+
+unsigned int audio_get_device_stats(AudioDeviceStats *out, unsigned int max)
+{
+    if (!open_settled())
+        return 0;
+    unsigned int n = g_fan.ndev < max ? g_fan.ndev : max;
+    for (unsigned int i = 0; i < n; ++i) {
+        const FanoutDevice *d = &g_fan.dev[i];
+        snprintf(out[i].name, sizeof out[i].name, "%s", d->name);
+        out[i].underruns     = __atomic_load_n(&d->underruns,
+                                               __ATOMIC_RELAXED);
+        out[i].skipped       = __atomic_load_n(&d->skipped, __ATOMIC_RELAXED);
+        out[i].plays         = __atomic_load_n(&d->plays, __ATOMIC_RELAXED);
+        out[i].period_frames = __atomic_load_n(&d->period_frames,
+                                               __ATOMIC_RELAXED);
+        out[i].drift_frames  = __atomic_load_n(&d->drift_frames,
+                                               __ATOMIC_RELAXED);
+    }
+    return n;
+}
+
+void audio_fanout_hold(unsigned int dev, bool hold)
+{
+    if (open_settled() && dev < g_fan.ndev)
+        __atomic_store_n(&g_fan.dev[dev].hold, hold, __ATOMIC_RELEASE);
+}
+
+/* --------------------------------------------------------------- */
+void audio_cleanup(void)
+{
+    open_wait();
+    if (g_fan.ndev)
+        fanout_close();
+    if (pcm_handle) {
+        snd_pcm_close(pcm_handle);
+        pcm_handle = NULL;
     }
+}
 
-    /* ---------- allocate a buffer that matches one period ---------- */
-    size_t samples_per_period = period_frames * sfinfo.channels;
-    short *buf = malloc(samples_per_period * sizeof *buf);
-    if (!buf) {
-        perror("malloc");
-        sf_close(sf);
+bool play_embedded_wav_by_name(const char *name)
+{
+    const EmbeddedWav e = asset_get(name);
+    if (!e.data) {
+        fprintf(stderr, "Embedded wav not found: %s\n", name);
         return false;
     }
 
-    /* ---------- playback loop ---------- */
-    sf_count_t frames_read;
-    while ((frames_read = sf_readf_short(sf, buf, period_frames)) > 0) {
-        size_t written = 0;
-        while (written < (size_t)frames_read) {
-            int rc = snd_pcm_wait(pcm_handle, 1000);
-            if (rc < 0) {
-                fprintf(stderr, "poll error: %s\n", strerror(-rc));
-                break;
-            }
+    /* ---------- parse the wav in place ---------- */
+    WavInfo wav;
+    if (!wav_parse(e.data, e.size, &wav)) {
+        fprintf(stderr, "Unsupported WAV (need 16‑bit PCM): %s\n", name);
+        return false;
+    }
 
-            rc = snd_pcm_writei(pcm_handle,
-                               buf + written * sfinfo.channels,
-                               frames_read - written);
-            if (rc == -EPIPE) {               /* underrun */
-                snd_pcm_prepare(pcm_handle);
-                continue;
-            }
-            if (rc < 0) {
-                if (snd_pcm_recover(pcm_handle, rc, 0) < 0) {
-                    fprintf(stderr, "ALSA write error: %s\n",
-                            snd_strerror(rc));
-                    free(buf);
-                    sf_close(sf);
-                    return false;
-                }
-                continue;
-            }
-            written += rc;
-        }
+    /* ---------- open ALSA if we haven’t already ---------- */
+    if (!audio_init())
+        return false;
+
+    /* ---------- (re)configure HW parameters only when they change ---------- */
+    if (!pcm_configure(wav.rate, wav.channels, 0))
+        return false;
+
+    /* ---------- playback loop, through the static period buffer ---------- */
+    size_t period = g_hw.period_frames;
+    if (period > period_buf_frames(wav.channels))
+        period = period_buf_frames(wav.channels);
+
+    const DspParams dsp = dsp_params(wav.rate);
+    short *buf = g_period_buf;
+    unsigned long xruns = 0;
+    for (size_t off = 0; off < wav.frames; off += period) {
+        size_t chunk = wav.frames - off < period ? wav.frames - off : period;
+        wav_copy_s16(buf, wav.pcm + off * wav.channels * 2,
+                     chunk * wav.channels);
+        dsp_segment_apply(&dsp, false, buf, chunk, wav.channels,
+                          off, wav.frames);
+        if (!pcm_write_frames(buf, chunk, wav.channels, &xruns))
+            return false;
     }
 
     /* ---------- finish cleanly ---------- */
-    snd_pcm_drain(pcm_handle);   /* let the last frames finish playing */
+    pcm_finish(true);   /* let the last frames finish playing */
     /* The device is now in the DRAINING/SETUP state → prepare it for the
      * next call (or let the code above do it on the next invocation). */
-
-    free(buf);
-    sf_close(sf);                /* frees the MemFile we allocated */
+    adapt_after_play(xruns);
     return true;
 }
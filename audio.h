@@ -14,7 +14,7 @@
  * ------------------------------------------------------------- */
 #include <stdbool.h>          /* bool, true, false               */
 #include <stddef.h>           /* size_t, NULL                    */
-#include <sndfile.h>          /* sf_count_t, SF_INFO, …          */
+#include <stdint.h>           /* int64_t                         */
 #include <alsa/asoundlib.h>   /* snd_pcm_t, snd_pcm_format_t …   */
 #include "wav_table.h"        /* EmbeddedWAV   */
 
@@ -35,9 +35,50 @@ extern EmbeddedWav get_embedded_wav(const char *name);
 /* Initialise the ALSA device (opens the default PCM). */
 bool audio_init(void);
 
+/* Start opening the device on a background thread and return at once.
+ * audio_init(), and so every play, waits for it to finish; the chain
+ * and staging calls do not need the device and never wait. */
+bool audio_init_async(void);
+
 /* Close the ALSA device and release any internal resources. */
 void audio_cleanup(void);
 
+/* Null sink: never open ALSA.  Plays still run the whole path – copy,
+ * DSP, period by period – but the periods go nowhere and nothing
+ * blocks.  For benchmarks, tests and headless runs; call before
+ * audio_init(). */
+void audio_set_null_sink(bool on);
+
+/* -----------------------------------------------------------------
+ *  Output devices.  audio_init() opens the PCMs named in CABATA_DEVICES
+ *  (separated by blanks; "default" if unset).  With more than one, a
+ *  play is decoded and processed once and fanned out: every device has
+ *  a writer thread reading the same stream at its own pace, a stalled
+ *  device skips ahead instead of holding up the others or the caller,
+ *  and clock drift is corrected a frame at a time.  Plays keep pace
+ *  with the fastest device and return when it is done, as with one.
+ *  With the null sink, the devices are opened as no PCM at all and
+ *  take as long to play as real ones would.
+ * ----------------------------------------------------------------- */
+#define AUDIO_MAX_DEVICES 8
+
+typedef struct {
+    char          name[64];
+    unsigned long underruns;       /* XRUNs on this device               */
+    unsigned long skipped;         /* stream slots skipped to catch up   */
+    unsigned long plays;           /* plays it reached the end of        */
+    unsigned long period_frames;   /* its own adaptive ALSA period       */
+    long          drift_frames;    /* frames repeated (+) / dropped (‑)  */
+} AudioDeviceStats;
+
+/* Counters of the fan‑out devices; returns how many were filled in –
+ * 0 when a single device is driven directly. */
+unsigned int audio_get_device_stats(AudioDeviceStats *out, unsigned int max);
+
+/* Test hook: stop fan‑out device ‘dev’ from reading the stream, as if
+ * it hung, until called again with ‘hold’ false. */
+void audio_fanout_hold(unsigned int dev, bool hold);
+
 /* -----------------------------------------------------------------
  *  “Play‑queue” – build a playlist of WAV segments that share the
  *  same sample‑rate and channel count, then play them back as one
@@ -47,19 +88,114 @@ bool audio_chain_init(void);                     /* reset internal state   */
 void audio_chain_cleanup(void);                  /* free allocated buffer  */
 
 bool audio_chain_add(const unsigned char *wav_buf,
-                     sf_count_t wav_len);       /* add raw memory block   */
+                     size_t wav_len);           /* add raw memory block   */
 
 bool audio_chain_add_by_name(const char *name);  /* add embedded asset     */
 
+/* Low‑priority segments (e.g. the motivational messages) are ducked
+ * by the DSP stage – see audio_set_dsp(). */
+typedef enum { AUDIO_PRIO_NORMAL, AUDIO_PRIO_LOW } AudioPriority;
+bool audio_chain_add_by_name_prio(const char *name, AudioPriority prio);
+
 bool audio_chain_play(void);                     /* drain the queue        */
 
 void audio_chain_reset(void);                    /* drop queued frames     */
 
+/* Streaming mode: audio_chain_add() only parses the segment header and
+ * audio_chain_play() copies each segment out of the asset period by
+ * period as it plays, so the first sample goes out before later
+ * segments are touched. */
+void audio_chain_set_streaming(bool on);
+
+/* Microseconds from the first add (or audio_chain_use_staged()) to the
+ * first frame handed to ALSA in the last audio_chain_play(); 0 if
+ * nothing was played. */
+unsigned long audio_chain_last_ttfs_us(void);
+
+/* DSP stage applied to every period on its way to ALSA: master gain
+ * (percent, up to ~199), the extra gain for AUDIO_PRIO_LOW segments
+ * (percent, up to 100) and the fade length at every segment join. */
+void audio_set_dsp(unsigned int gain_pct, unsigned int duck_pct,
+                   unsigned int fade_ms);
+
+/* -----------------------------------------------------------------
+ *  Phrases – several assets said as one, e.g. a composed number
+ *  ("num2" "hundred" "num70" "num5").  The first use joins the parts,
+ *  with the silence between the words trimmed, into a cache slot;
+ *  later uses add that as a single segment, as cheap as one asset.
+ *  Falls back to adding the parts one by one when they cannot be
+ *  joined (formats differ, too long).
+ * ----------------------------------------------------------------- */
+bool audio_chain_add_phrase(const char *const *parts, unsigned int n);
+
+/* Forget every cached phrase – after the assets changed (SIGHUP). */
+void audio_phrases_flush(void);
+
+/* -----------------------------------------------------------------
+ *  Staging – prepare the *next* chain ahead of time.  Between
+ *  audio_chain_stage_begin() and audio_chain_stage_end() every
+ *  audio_chain_add*() goes to a second buffer; audio_chain_use_staged()
+ *  later swaps that buffer in as the queue (false if nothing staged).
+ * ----------------------------------------------------------------- */
+void audio_chain_stage_begin(void);
+void audio_chain_stage_end(void);
+bool audio_chain_use_staged(void);
+
+/* -----------------------------------------------------------------
+ *  Countdown cues – short clips (the final‑seconds numbers) copied
+ *  once into a static pool with the silence around the word trimmed
+ *  off.  A cue play gets a device buffer of at least AUDIO_CUE_MAX_MS,
+ *  so audio_cue_play() queues the whole cue without blocking and does
+ *  not drain: the caller is back waiting for the next second while
+ *  ALSA plays the cue on its own.
+ * ----------------------------------------------------------------- */
+#define AUDIO_CUE_SLOTS   10
+#define AUDIO_CUE_MAX_MS  900    /* must end well before the next second */
+
+typedef struct {
+    int64_t onset_ns;            /* CLOCK_MONOTONIC: first period taken */
+    int64_t end_ns;              /* onset + cue length                  */
+} AudioCueTiming;
+
+/* Load the assets ‘names[0..n)’ into cue slots 0..n‑1, replacing the
+ * previous set.  False – and no cues – if one is missing, not 16‑bit
+ * PCM, or longer than AUDIO_CUE_MAX_MS once trimmed. */
+bool audio_cues_load(const char *const *names, unsigned int n);
+
+/* Play cue ‘slot’ and report when it started and will end. */
+bool audio_cue_play(unsigned int slot, AudioCueTiming *t);
+
+/* -----------------------------------------------------------------
+ *  Real‑time mode and telemetry.
+ * ----------------------------------------------------------------- */
+typedef struct {
+    bool          rt_sched;        /* running SCHED_FIFO                 */
+    bool          mem_locked;      /* playback memory is mlock'ed…       */
+    bool          mem_locked_all;  /* …via mlockall() (else buffers only)*/
+    unsigned long underruns;       /* ALSA -EPIPE on write (XRUNs)       */
+    unsigned long period_frames;   /* current ALSA period…               */
+    unsigned long buffer_frames;   /* …and buffer size                   */
+    unsigned long period_grows;    /* adaptive policy: size doubled      */
+    unsigned long period_shrinks;  /* adaptive policy: size halved       */
+    unsigned long open_us;         /* device open, in the background…    */
+    unsigned long open_wait_us;    /* …and how long a play waited for it */
+    unsigned long phrase_hits;     /* phrases added from the cache…      */
+    unsigned long phrase_misses;   /* …and composed on the spot          */
+} AudioStats;
+
+/* Opt‑in: move the playback path (the calling thread) to SCHED_FIFO at
+ * ‘priority’ and mlock the assets and chain buffers.  Never fatal – a
+ * missing privilege falls back to nice / partial locking and is logged.
+ * Returns true when SCHED_FIFO was granted. */
+bool audio_rt_enable(int priority);
+
+void audio_get_stats(AudioStats *out);
+
 /* -----------------------------------------------------------------
  *  One‑shot playback helpers (no queue, just play the given buffer).
  * ----------------------------------------------------------------- */
 bool audio_play_wav_mem(const unsigned char *wav_buf,
-                        sf_count_t wav_len);
+                        size_t wav_len);
 
 /* Play an embedded WAV identified by its name (no queue). */
 bool play_embedded_wav_by_name(const char *name);
@@ -0,0 +1,117 @@
+#ifndef BENCH_DAEMON_H
+#define BENCH_DAEMON_H
+
+/* -------------------------------------------------------------
+ *  What the daemon benchmarks share: a private daemon to measure,
+ *  a clock, and percentiles.
+ *
+ *  bench_daemon_env() points this process – and so everything it
+ *  forks or execs – at a null‑sink daemon on a pid‑suffixed socket,
+ *  state file, history and status page under /tmp, so a daemon
+ *  already running for real is left alone.  bench_daemon_spawn()
+ *  starts it; bench_daemon_cleanup() removes its files once it quit.
+ *
+ *  Header‑only, like the status page reader.
+ * ------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+static char bench_sock_path[108];
+static char bench_state_path[128];
+static char bench_history_path[128];
+
+static inline unsigned long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000000000ul + ts.tv_nsec;
+}
+
+/* qsort() order for latencies */
+static inline int cmp_ul(const void *a, const void *b)
+{
+    unsigned long x = *(const unsigned long *)a;
+    unsigned long y = *(const unsigned long *)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentile ‘p’ (0.5, 0.99…) of the ‘n’ sorted ns values ‘v’, in us */
+#define PCT(v, n, p) ((v)[(size_t)(((n) - 1) * (p))] / 1000.0)
+
+static inline void bench_daemon_env(void)
+{
+    const int pid = (int)getpid();
+    char shm[64];
+    snprintf(bench_sock_path, sizeof(bench_sock_path),
+             "/tmp/cabata-bench-%d.sock", pid);
+    snprintf(bench_state_path, sizeof(bench_state_path),
+             "/tmp/cabata-bench-%d.state", pid);
+    snprintf(bench_history_path, sizeof(bench_history_path),
+             "/tmp/cabata-bench-%d.history", pid);
+    snprintf(shm, sizeof(shm), "/cabata-bench-%d", pid);
+    setenv("CABATA_AUDIO", "null", 1);
+    setenv("CABATA_SOCK", bench_sock_path, 1);
+    setenv("CABATA_STATE", bench_state_path, 1);
+    setenv("CABATA_HISTORY", bench_history_path, 1);
+    setenv("CABATA_SHM", shm, 1);
+}
+
+/* One CLI‑style exchange: connect, send, read until the daemon closes */
+static inline bool bench_roundtrip(const char *cmd)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", bench_sock_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        return false;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        write(fd, cmd, strlen(cmd)) != (ssize_t)strlen(cmd)) {
+        close(fd);
+        return false;
+    }
+
+    char reply[1024];
+    ssize_t n, total = 0;
+    while ((n = read(fd, reply, sizeof(reply))) > 0)
+        total += n;
+    close(fd);
+    return n == 0 && total > 0;
+}
+
+/* Start the daemon under test and wait for its socket */
+static inline bool bench_daemon_spawn(const char *cabata)
+{
+    pid_t pid = fork();
+    if (pid == -1)
+        return false;
+    if (pid == 0) {
+        execl(cabata, cabata, "--daemon", (char *)NULL);
+        _exit(127);
+    }
+    waitpid(pid, NULL, 0);              /* daemon() forks and returns */
+
+    for (int i = 0; i < 500; ++i) {     /* up to 5 s */
+        if (bench_roundtrip("status\n"))
+            return true;
+        struct timespec ts = { 0, 10000000 };
+        nanosleep(&ts, NULL);
+    }
+    fprintf(stderr, "daemon did not come up on %s\n", bench_sock_path);
+    return false;
+}
+
+static inline void bench_daemon_cleanup(void)
+{
+    unlink(bench_state_path);
+    unlink(bench_history_path);
+}
+
+#endif /* BENCH_DAEMON_H */
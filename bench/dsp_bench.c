@@ -0,0 +1,85 @@
+/* dsp_bench.c
+ *
+ * How much of a 10 ms playback period does the DSP stage cost?
+ *
+ * Usage:
+ *   dsp_bench [iterations]
+ *
+ * For each case one 10 ms period is processed ‘iterations’ times with
+ * dsp_segment_apply(), exactly as audio_chain_play() does it, and the
+ * mean cost is printed in ns and as a share of the period's 10 ms.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dsp.h"
+
+#define PERIOD_NS 10000000.0
+
+typedef struct {
+    const char  *name;
+    unsigned int rate;
+    unsigned int channels;
+    bool         low_prio;
+    size_t       off;        /* position inside a 1 s segment */
+} Case;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    long iters = argc > 1 ? atol(argv[1]) : 200000;
+    if (iters <= 0) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* 16 kHz mono is what the embedded voice assets are */
+    const Case cases[] = {
+        { "16k mono  steady gain",   16000, 1, false, 4000 },
+        { "16k mono  ducked",        16000, 1, true,  4000 },
+        { "16k mono  fade in",       16000, 1, false, 0    },
+        { "48k stereo steady gain",  48000, 2, false, 12000 },
+        { "48k stereo fade out",     48000, 2, false, 47520 },
+    };
+
+    printf("%-26s %10s %10s\n", "case", "ns/period", "% of 10ms");
+    for (size_t c = 0; c < sizeof cases / sizeof *cases; ++c) {
+        const Case *k = &cases[c];
+        size_t frames = k->rate / 100;
+        size_t samples = frames * k->channels;
+        int16_t *src = malloc(samples * sizeof *src);
+        int16_t *buf = malloc(samples * sizeof *buf);
+        if (!src || !buf) { perror("malloc"); return EXIT_FAILURE; }
+        for (size_t i = 0; i < samples; ++i)
+            src[i] = (int16_t)((i * 7919u) & 0x7fff) - 16384;
+
+        DspParams p = { .gain_q15 = DSP_UNITY * 8 / 10,
+                        .duck_q15 = DSP_UNITY / 2,
+                        .fade_frames = k->rate * 5 / 1000 };
+
+        volatile int16_t sink = 0;
+        double t0 = now_ns();
+        for (long it = 0; it < iters; ++it) {
+            memcpy(buf, src, samples * sizeof *buf);
+            dsp_segment_apply(&p, k->low_prio, buf, frames, k->channels,
+                              k->off, k->rate);
+            sink ^= buf[it % samples];
+        }
+        double mean = (now_ns() - t0) / iters;
+        (void)sink;
+
+        printf("%-26s %10.0f %9.4f%%\n", k->name, mean,
+               100.0 * mean / PERIOD_NS);
+        free(src);
+        free(buf);
+    }
+    return EXIT_SUCCESS;
+}
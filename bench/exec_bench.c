@@ -0,0 +1,95 @@
+/* exec_bench.c
+ *
+ * What does one "cabata status" cost from the caller's side – exec,
+ * dynamic linking, connect, reply, exit?
+ *
+ * Usage:
+ *   exec_bench [-n runs] <cabata> [client ...]
+ *
+ * Starts its own daemon from the ‘cabata’ binary with the null audio
+ * sink and a private socket, state file, history and status page, like
+ * sock_bench.  Then runs "<binary> status" ‘runs’ times (default 500)
+ * for cabata itself and for every further client binary given, e.g.
+ * ./cabatac, one at a time with stdout on /dev/null, and prints the
+ * p50/p99/max of fork‑to‑exit time per binary.  "status --shm" is
+ * measured too; it never reaches the daemon.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include "bench_daemon.h"
+
+/* Run ‘bin’ with ‘arg1’ [‘arg2’], stdout to /dev/null; true on exit 0 */
+static bool run(const char *bin, const char *arg1, const char *arg2)
+{
+    pid_t pid = fork();
+    if (pid == -1)
+        return false;
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null != -1)
+            dup2(null, STDOUT_FILENO);
+        execl(bin, bin, arg1, arg2, (char *)NULL);
+        _exit(127);
+    }
+    int status;
+    return waitpid(pid, &status, 0) == pid &&
+           WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/* Time ‘runs’ executions of "bin status [--shm]" */
+static long measure(const char *bin, const char *flag, unsigned long *v,
+                    long runs)
+{
+    long failed = 0;
+    run(bin, "status", flag);           /* warm the page cache */
+    for (long i = 0; i < runs; ++i) {
+        unsigned long t0 = now_ns();
+        if (!run(bin, "status", flag))
+            failed++;
+        v[i] = now_ns() - t0;
+    }
+    qsort(v, (size_t)runs, sizeof *v, cmp_ul);
+    printf("%-28s %-7s %9.1f %9.1f %9.1f %7ld\n",
+           bin, flag ? flag : "socket", PCT(v, runs, 0.50),
+           PCT(v, runs, 0.99), v[runs - 1] / 1000.0, failed);
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    long runs = 500;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n': runs = atol(optarg); break;
+        default:  runs = 0; break;
+        }
+    }
+    if (optind >= argc || runs <= 0) {
+        fprintf(stderr, "Usage: %s [-n runs] <cabata> [client ...]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Everything exec'ed from here on talks to the private daemon */
+    bench_daemon_env();
+    if (!bench_daemon_spawn(argv[optind]))
+        return EXIT_FAILURE;
+
+    unsigned long *v = malloc((size_t)runs * sizeof *v);
+    if (!v) { perror("malloc"); return EXIT_FAILURE; }
+
+    printf("%ld runs of \"status\" each\n\n", runs);
+    printf("%-28s %-7s %9s %9s %9s %7s   (us)\n",
+           "binary", "path", "p50", "p99", "max", "failed");
+    long failed = 0;
+    for (int i = optind; i < argc; ++i) {
+        failed += measure(argv[i], NULL, v, runs);
+        failed += measure(argv[i], "--shm", v, runs);
+    }
+
+    run(argv[optind], "quit", NULL);
+    bench_daemon_cleanup();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/* history_bench.c
+ *
+ * What does an append to the workout history cost, and how long does
+ * "history" take over years of sessions?
+ *
+ * Usage:
+ *   history_bench [sessions]
+ *
+ * Appends ‘sessions’ records (default 100000 – ten a day for 27 years,
+ * one day after the other) to a private history file with
+ * history_append(), then summarizes the file 20 times with
+ * history_summarize(), and prints the mean cost of each.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "history.h"
+
+#define QUERIES 20
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    long sessions = argc > 1 ? atol(argv[1]) : 100000;
+    if (sessions <= 0) {
+        fprintf(stderr, "Usage: %s [sessions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/cabata-bench-%d.history",
+             (int)getpid());
+    unlink(path);
+    if (!history_open(path))
+        return EXIT_FAILURE;
+
+    /* Ten sessions a day, ending today */
+    const int64_t now = (int64_t)time(NULL);
+    const int64_t first = now - (sessions / 10) * 86400;
+    double t0 = now_ns();
+    for (long i = 0; i < sessions; ++i) {
+        HistorySession s = {
+            .start       = first + (i / 10) * 86400 + (i % 10) * 3600,
+            .total_sec   = 240,
+            .work_sec    = 160,
+            .planned_sec = 240,
+            .rounds      = 8,
+            .completed   = i % 7 != 0,
+        };
+        if (!history_append(&s))
+            return EXIT_FAILURE;
+    }
+    double append_ns = (now_ns() - t0) / sessions;
+
+    HistorySummary h;
+    const int32_t today = history_day(now);
+    t0 = now_ns();
+    for (int q = 0; q < QUERIES; ++q)
+        if (!history_summarize(today, &h))
+            return EXIT_FAILURE;
+    double query_us = (now_ns() - t0) / QUERIES / 1000.0;
+
+    printf("%ld sessions, %lu KiB\n", sessions,
+           (unsigned long)h.records * 48 / 1024);
+    printf("append   %8.0f ns\n", append_ns);
+    printf("history  %8.1f us  (%.1f ns per record)\n",
+           query_us, query_us * 1000.0 / sessions);
+    printf("streak %u days, longest %u\n",
+           h.streak_days, h.longest_streak_days);
+
+    history_close();
+    unlink(path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/* sock_bench.c
+ *
+ * How does the daemon's control plane hold up under concurrent clients?
+ *
+ * Usage:
+ *   sock_bench [-c clients] [-n requests] [-m start:stop:status] <cabata>
+ *
+ * Starts its own daemon from the ‘cabata’ binary with the null audio
+ * sink and a private socket, state file, history and status page, so
+ * a daemon already running for real is left alone.  Then ‘clients’ threads
+ * (default 8) each send ‘requests’ commands (default 2000), one
+ * connection per command exactly like the CLI, picking start / stop /
+ * status with the given weights (default 1:1:8).  Prints throughput
+ * and the p50/p99/p99.9/max round‑trip latency per command and overall,
+ * then asks the daemon to quit.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include "bench_daemon.h"
+
+enum { CMD_START, CMD_STOP, CMD_STATUS, CMDS };
+
+static const char *const cmd_text[CMDS] = {
+    "start 20 10 8\n", "stop\n", "status\n"
+};
+static const char *const cmd_name[CMDS] = { "start", "stop", "status" };
+
+typedef struct {
+    unsigned int  seed;
+    long          requests;
+    unsigned long *lat_ns[CMDS];   /* per command, unsorted */
+    long          n[CMDS];
+    long          failed;          /* connect / IO errors, not ERR replies */
+} Client;
+
+static unsigned weight[CMDS] = { 1, 1, 8 };
+
+static void *client_main(void *arg)
+{
+    Client *c = arg;
+    const unsigned sum = weight[CMD_START] + weight[CMD_STOP] +
+                         weight[CMD_STATUS];
+
+    for (long i = 0; i < c->requests; ++i) {
+        unsigned r = (unsigned)rand_r(&c->seed) % sum;
+        int k = r < weight[CMD_START] ? CMD_START
+              : r < weight[CMD_START] + weight[CMD_STOP] ? CMD_STOP
+              : CMD_STATUS;
+
+        unsigned long t0 = now_ns();
+        if (!bench_roundtrip(cmd_text[k])) {
+            c->failed++;
+            continue;
+        }
+        c->lat_ns[k][c->n[k]++] = now_ns() - t0;
+    }
+    return NULL;
+}
+
+static void report(const char *name, unsigned long *v, long n)
+{
+    if (n == 0) {
+        printf("%-8s %8ld\n", name, n);
+        return;
+    }
+    qsort(v, (size_t)n, sizeof *v, cmp_ul);
+    printf("%-8s %8ld %9.1f %9.1f %9.1f %9.1f\n", name, n,
+           PCT(v, n, 0.50), PCT(v, n, 0.99), PCT(v, n, 0.999),
+           v[n - 1] / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    int clients = 8;
+    long requests = 2000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:m:")) != -1) {
+        switch (opt) {
+        case 'c': clients  = atoi(optarg); break;
+        case 'n': requests = atol(optarg); break;
+        case 'm':
+            if (sscanf(optarg, "%u:%u:%u", &weight[CMD_START],
+                       &weight[CMD_STOP], &weight[CMD_STATUS]) != 3)
+                clients = 0;
+            break;
+        default:  clients = 0; break;
+        }
+    }
+    if (optind != argc - 1 || clients <= 0 || requests <= 0 ||
+        weight[CMD_START] + weight[CMD_STOP] + weight[CMD_STATUS] == 0) {
+        fprintf(stderr, "Usage: %s [-c clients] [-n requests] "
+                        "[-m start:stop:status] <cabata>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_daemon_env();
+    if (!bench_daemon_spawn(argv[optind]))
+        return EXIT_FAILURE;
+
+    Client   *c  = calloc((size_t)clients, sizeof *c);
+    pthread_t *t = calloc((size_t)clients, sizeof *t);
+    if (!c || !t) { perror("calloc"); return EXIT_FAILURE; }
+    for (int i = 0; i < clients; ++i) {
+        c[i].seed = (unsigned)i * 2654435761u + 1;
+        c[i].requests = requests;
+        for (int k = 0; k < CMDS; ++k) {
+            c[i].lat_ns[k] = malloc((size_t)requests * sizeof(unsigned long));
+            if (!c[i].lat_ns[k]) { perror("malloc"); return EXIT_FAILURE; }
+        }
+    }
+
+    unsigned long t0 = now_ns();
+    for (int i = 0; i < clients; ++i)
+        pthread_create(&t[i], NULL, client_main, &c[i]);
+    for (int i = 0; i < clients; ++i)
+        pthread_join(t[i], NULL);
+    double secs = (now_ns() - t0) / 1e9;
+
+    bench_roundtrip("quit\n");
+    bench_daemon_cleanup();
+
+    /* Merge the per‑client samples */
+    long total = 0, failed = 0;
+    unsigned long *all = malloc((size_t)clients * requests * sizeof *all);
+    if (!all) { perror("malloc"); return EXIT_FAILURE; }
+
+    printf("%d clients x %ld requests, mix %u:%u:%u\n\n",
+           clients, requests, weight[CMD_START], weight[CMD_STOP],
+           weight[CMD_STATUS]);
+    printf("%-8s %8s %9s %9s %9s %9s   (us)\n",
+           "command", "n", "p50", "p99", "p99.9", "max");
+    for (int k = 0; k < CMDS; ++k) {
+        long n = 0;
+        for (int i = 0; i < clients; ++i)
+            n += c[i].n[k];
+        unsigned long *v = malloc(((size_t)n + 1) * sizeof *v);
+        if (!v) { perror("malloc"); return EXIT_FAILURE; }
+        n = 0;
+        for (int i = 0; i < clients; ++i) {
+            memcpy(v + n, c[i].lat_ns[k], (size_t)c[i].n[k] * sizeof *v);
+            memcpy(all + total, c[i].lat_ns[k], (size_t)c[i].n[k] * sizeof *v);
+            n += c[i].n[k];
+            total += c[i].n[k];
+        }
+        report(cmd_name[k], v, n);
+        free(v);
+    }
+    report("all", all, total);
+    for (int i = 0; i < clients; ++i)
+        failed += c[i].failed;
+
+    printf("\n%.0f requests/s over %.2f s, %ld failed\n",
+           total / secs, secs, failed);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
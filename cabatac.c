@@ -0,0 +1,48 @@
+/* cabatac.c
+ *
+ * Lightweight client: the client half of cabata (client.c) without the
+ * daemon, the audio libraries or the embedded WAVs.  Takes the same
+ * commands:
+ *
+ *   cabatac status --shm
+ *   cabatac start 20 10 8
+ *
+ * When no daemon is running it starts "cabata --daemon" – the cabata
+ * installed next to this binary, or the one named by CABATA_DAEMON.
+ *
+ * Build static with "make cabatac STATIC=1".
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include "client.h"
+
+/* <directory of this executable>/cabata, else "cabata" from PATH */
+static const char *daemon_path(void)
+{
+    static char path[PATH_MAX];
+    const char *env = getenv("CABATA_DAEMON");
+    if (env && *env)
+        return env;
+
+    ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (n > 0) {
+        path[n] = '\0';
+        char *slash = strrchr(path, '/');
+        if (slash && (size_t)(slash - path) + sizeof("/cabata") <= sizeof(path)) {
+            strcpy(slash, "/cabata");
+            if (access(path, X_OK) == 0)
+                return path;
+        }
+    }
+    return "cabata";
+}
+
+int main(int argc, char *argv[])
+{
+    return client_main(argc, argv, daemon_path());
+}
@@ -0,0 +1,224 @@
+/* client.c
+ *
+ * The command‑line side of cabata (see client.h): build the command,
+ * talk to the daemon over SOCK_PATH, print what it says.
+ *
+ * Links against libc only – no audio, no embedded WAVs – so that
+ * "cabatac", built from this file and cabatac.c, starts in well under
+ * a millisecond.  CABATA_SOCK and CABATA_SHM are honoured exactly as
+ * by the daemon.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "client.h"
+#include "status_page.h"
+
+/* How long a freshly spawned daemon gets to start listening; polled
+   with a doubling delay, so a fast start costs ~1 ms, not a second. */
+#define SPAWN_WAIT_MS      2000
+#define SPAWN_POLL_MAX_MS  64
+
+static const char *sock_path = SOCK_PATH;
+static const char *shm_name  = STATUS_PAGE_NAME;
+
+/* ----------------------------------------------------------------------
+   Connection – and starting the daemon when there is none
+   ---------------------------------------------------------------------- */
+static int connect_daemon(void)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sock_path, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+static void spawn_daemon(const char *daemon_path)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        execlp(daemon_path, daemon_path, "--daemon", (char *)NULL);
+        perror(daemon_path);
+        _exit(EXIT_FAILURE);
+    }
+    if (pid > 0)
+        waitpid(pid, NULL, 0);        /* daemon() forks and returns */
+}
+
+static int connect_or_spawn(const char *daemon_path)
+{
+    int fd = connect_daemon();
+    if (fd != -1 || (errno != ENOENT && errno != ECONNREFUSED))
+        return fd;
+
+    /* stale socket – delete it and spawn the daemon */
+    unlink(sock_path);
+    spawn_daemon(daemon_path);
+
+    long waited = 0;
+    for (long ms = 1; fd == -1 && waited < SPAWN_WAIT_MS; waited += ms) {
+        struct timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+        nanosleep(&ts, NULL);
+        fd = connect_daemon();
+        if (ms < SPAWN_POLL_MAX_MS)
+            ms *= 2;
+    }
+    return fd;
+}
+
+/* ----------------------------------------------------------------------
+   Send a command to the daemon and print the reply
+   ---------------------------------------------------------------------- */
+static void client_send(const char *cmd, const char *daemon_path)
+{
+    int fd = connect_or_spawn(daemon_path);
+    if (fd == -1) {
+        perror("connect");
+        exit(EXIT_FAILURE);
+    }
+
+    /* ----- send the command – in one write, the daemon reads once ----- */
+    char line[MAX_CMD_LEN + 1];
+    int len = snprintf(line, sizeof(line), "%s\n", cmd);
+    write(fd, line, (size_t)len);
+
+    /* The reply may span several lines – read until the daemon closes */
+    char reply[256];
+    ssize_t n;
+    while ((n = read(fd, reply, sizeof(reply) - 1)) > 0) {
+        reply[n] = '\0';
+        fputs(reply, stdout);
+    }
+    close(fd);
+}
+
+/* ----------------------------------------------------------------------
+   "status --shm": answer from the status page without waking (or
+   starting) the daemon
+   ---------------------------------------------------------------------- */
+static int client_status_shm(void)
+{
+    const StatusPage *pg = status_page_map(shm_name);
+    StatusData d;
+    if (!pg || !status_page_read(pg, &d) || d.pid == 0 ||
+        (kill((pid_t)d.pid, 0) == -1 && errno == ESRCH)) {
+        fprintf(stderr, "No daemon running\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!d.running)
+        printf("IDLE\n");
+    else
+        printf("RUNNING round %llu/%llu %s %llu sec left\n",
+               (unsigned long long)d.round, (unsigned long long)d.rounds,
+               d.work ? "WORK" : "REST",
+               (unsigned long long)d.sec_remaining);
+    return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------
+   argv → command line
+   ---------------------------------------------------------------------- */
+int client_main(int argc, char *argv[], const char *daemon_path)
+{
+    const char *env;
+    if ((env = getenv("CABATA_SOCK")) && *env) sock_path = env;
+    if ((env = getenv("CABATA_SHM"))  && *env) shm_name  = env;
+
+    if (argc < 2) {
+        fprintf(stderr,
+                "Usage: %s <command> [args]\n"
+                "Commands:\n"
+                "  start <work_sec> <rest_sec> <rounds>\n"
+                "  program <file>\n"
+                "  stop\n"
+                "  status [--shm]\n"
+                "  next\n"
+                "  stats\n"
+                "  history\n"
+                "  trace dump   (Chrome trace JSON, for Perfetto)\n"
+                "  quit   (stop daemon)\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Build the command string that will be sent to the daemon */
+    char cmd_buf[MAX_CMD_LEN] = {0};
+
+    if (strcmp(argv[1], "start") == 0) {
+        if (argc != 5) {
+            fprintf(stderr, "start needs three numbers: work rest rounds\n");
+            return EXIT_FAILURE;
+        }
+        snprintf(cmd_buf, sizeof(cmd_buf), "start %s %s %s",
+                 argv[2], argv[3], argv[4]);
+    } else if (strcmp(argv[1], "program") == 0) {
+        /* The daemon runs in /, so it needs an absolute path */
+        char path[PATH_MAX];
+        if (argc != 3) {
+            fprintf(stderr, "program needs a program file\n");
+            return EXIT_FAILURE;
+        }
+        if (!realpath(argv[2], path)) {
+            perror(argv[2]);
+            return EXIT_FAILURE;
+        }
+        if (snprintf(cmd_buf, sizeof(cmd_buf), "program %s", path)
+            >= (int)sizeof(cmd_buf)) {
+            fprintf(stderr, "program path too long\n");
+            return EXIT_FAILURE;
+        }
+    } else if (strcmp(argv[1], "stop") == 0) {
+        strcpy(cmd_buf, "stop");
+    } else if (strcmp(argv[1], "status") == 0) {
+        if (argc == 3 && strcmp(argv[2], "--shm") == 0)
+            return client_status_shm();
+        strcpy(cmd_buf, "status");
+    } else if (strcmp(argv[1], "next") == 0) {
+        strcpy(cmd_buf, "next");
+    } else if (strcmp(argv[1], "stats") == 0) {
+        strcpy(cmd_buf, "stats");
+    } else if (strcmp(argv[1], "history") == 0) {
+        strcpy(cmd_buf, "history");
+    } else if (strcmp(argv[1], "trace") == 0) {
+        if (argc != 3 || strcmp(argv[2], "dump") != 0) {
+            fprintf(stderr, "usage: trace dump > trace.json\n");
+            return EXIT_FAILURE;
+        }
+        strcpy(cmd_buf, "trace dump");
+    } else if (strcmp(argv[1], "quit") == 0) {
+        strcpy(cmd_buf, "quit");
+    } else {
+        fprintf(stderr, "Unknown command '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    client_send(cmd_buf, daemon_path);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,22 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+/* -------------------------------------------------------------
+ *  Command‑line client: turns argv into one command line, sends it
+ *  over the control socket and prints the reply; starts the daemon
+ *  first if nobody is listening.
+ *
+ *  Nothing here touches audio, so the same code is both the client
+ *  half of "cabata" and all of "cabatac", the small client that
+ *  status bars and scripts can exec many times a minute.
+ * ------------------------------------------------------------- */
+
+#define SOCK_PATH   "/tmp/tabata_timer.sock"
+#define MAX_CMD_LEN 256
+
+/* Run the client for ‘argv’ and return the exit status.  ‘daemon_path’
+ * is the binary started as "<daemon_path> --daemon" when no daemon is
+ * running; a name without a slash is looked up in PATH. */
+int client_main(int argc, char *argv[], const char *daemon_path);
+
+#endif /* CLIENT_H */
@@ -0,0 +1,38 @@
+#ifndef DSP_H
+#define DSP_H
+
+/* -------------------------------------------------------------
+ *  Per‑voice DSP for announcement output: gain, short fades at the
+ *  joins between chained clips and ducking of low‑priority clips.
+ *
+ *  Everything works in place on interleaved S16 samples, one period
+ *  at a time, so the playback path can apply it to the chunk it is
+ *  about to hand to ALSA.  Gains are Q15 (DSP_UNITY == 1.0) and may
+ *  go up to DSP_GAIN_MAX (~2.0); results saturate.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DSP_UNITY     32768
+#define DSP_GAIN_MAX  65535
+
+typedef struct {
+    int32_t  gain_q15;      /* master gain for every segment          */
+    int32_t  duck_q15;      /* extra gain for low‑priority segments   */
+    uint32_t fade_frames;   /* fade in/out length at segment edges    */
+} DspParams;
+
+/* Kernels – exposed for the benchmark. */
+void dsp_gain_s16(int16_t *buf, size_t samples, int32_t gain_q15);
+void dsp_ramp_s16(int16_t *buf, size_t frames, unsigned int channels,
+                  int32_t from_q15, int32_t to_q15);
+
+/* Process frames [off, off + frames) of a segment that is ‘seg_frames’
+ * long: fade in over its first fade_frames, out over its last ones,
+ * master gain everywhere, duck gain on top when ‘low_prio’. */
+void dsp_segment_apply(const DspParams *p, bool low_prio,
+                       int16_t *buf, size_t frames, unsigned int channels,
+                       size_t off, size_t seg_frames);
+
+#endif /* DSP_H */
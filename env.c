@@ -0,0 +1,25 @@
+/*=====================================================================
+ *  env.c  –  numeric settings from the environment (see env.h)
+ *====================================================================*/
+#include "env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+unsigned env_uint(const char *name, unsigned def, unsigned min,
+                  unsigned max)
+{
+    const char *v = getenv(name);
+    if (!v || !*v)
+        return def;
+
+    char *end;
+    errno = 0;
+    long n = strtol(v, &end, 10);
+    if (errno || *end || n < (long)min || n > (long)max) {
+        fprintf(stderr, "%s=%s: not a number from %u to %u, using %u\n",
+                name, v, min, max, def);
+        return def;
+    }
+    return (unsigned)n;
+}
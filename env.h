@@ -0,0 +1,15 @@
+#ifndef ENV_H
+#define ENV_H
+
+/* -------------------------------------------------------------
+ *  Numeric settings from the environment (the CABATA_* knobs),
+ *  checked the same way wherever they are read.
+ * ------------------------------------------------------------- */
+
+/* The whole number from ‘min’ to ‘max’ in variable ‘name’ – ‘def’ when
+ * it is unset or empty, and (with a warning) when it is anything else,
+ * so that e.g. CABATA_GAIN=-5 does not wrap around to full volume. */
+unsigned env_uint(const char *name, unsigned def, unsigned min,
+                  unsigned max);
+
+#endif /* ENV_H */
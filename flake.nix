@@ -25,7 +25,6 @@
         src = ./.;
         buildInputs = with pkgs; [
           alsa-lib
-          libsndfile
         ];
         nativeBuildInputs = with pkgs; [
           pkg-config
@@ -42,6 +41,10 @@
           packages.default = pkgs.stdenv.mkDerivation {
             inherit buildInputs nativeBuildInputs pname version src;
             dontConfigure = true;
+            doCheck = true;
+            checkPhase = ''
+               make check
+            '';
             installPhase = ''
                make clean
                make install BINDIR=$out/bin/
@@ -21,6 +21,11 @@ let
     minutesleft = "minutes left";
     secondsleft = "seconds left";
     hours = "hours";
+    num70 = "70";
+    num80 = "80";
+    num90 = "90";
+    hundred = "hundred";
+    thousand = "thousand";
     minutes = "minutes";
     seconds = "seconds";
     done = "done!";
@@ -0,0 +1,219 @@
+/*=====================================================================
+ *  history.c  –  append‑only workout history (see history.h)
+ *====================================================================*/
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE                     /* tm_gmtoff */
+#include "history.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HISTORY_MAGIC 0x31484243u       /* "CBH1" */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;                  /* over everything below      */
+    int64_t  start;
+    int32_t  day;                       /* history_day(start)         */
+    uint32_t total_sec;
+    uint32_t work_sec;
+    uint32_t planned_sec;
+    uint32_t rounds;
+    uint8_t  completed;
+    uint8_t  reserved[11];              /* zero – room for more fields */
+} HistoryRecord;
+
+_Static_assert(sizeof(HistoryRecord) == 48, "history record size");
+
+static int g_fd = -1;
+
+/* FNV‑1a – cheap, and only has to catch torn writes */
+static uint32_t record_checksum(const HistoryRecord *r)
+{
+    const unsigned char *p = (const unsigned char *)r;
+    uint32_t h = 2166136261u;
+    for (size_t i = offsetof(HistoryRecord, start); i < sizeof *r; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Monday‑based week number; day 0, 1970‑01‑01, was a Thursday */
+static int32_t week_of(int32_t day)
+{
+    const int32_t d = day + 3;
+    return d >= 0 ? d / 7 : (d - 6) / 7;
+}
+
+/*=====================================================================
+ *  PUBLIC API
+ *====================================================================*/
+/* Does the file start like a history file – empty, or with a record
+   (whole or torn) that has the magic? */
+static bool history_file(int fd, const struct stat *st)
+{
+    if (!S_ISREG(st->st_mode))
+        return false;
+    if (st->st_size == 0)
+        return true;
+
+    const uint32_t magic = HISTORY_MAGIC;
+    const size_t n = st->st_size < (off_t)sizeof magic ? (size_t)st->st_size
+                                                       : sizeof magic;
+    unsigned char head[sizeof magic];
+    return pread(fd, head, n, 0) == (ssize_t)n &&
+           memcmp(head, &magic, n) == 0;
+}
+
+bool history_open(const char *path)
+{
+    int fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_NOFOLLOW | O_CLOEXEC,
+                  0600);
+    if (fd == -1) {
+        fprintf(stderr, "history: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        fprintf(stderr, "history: %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    if (!history_file(fd, &st)) {
+        fprintf(stderr, "history: %s: not a history file, left alone\n",
+                path);
+        close(fd);
+        return false;
+    }
+
+    /* A crash mid‑append can leave part of a record at the end */
+    if (st.st_size % sizeof(HistoryRecord) &&
+        ftruncate(fd, st.st_size - st.st_size % sizeof(HistoryRecord)) == -1) {
+        fprintf(stderr, "history: %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    g_fd = fd;
+    return true;
+}
+
+bool history_append(const HistorySession *s)
+{
+    if (g_fd == -1)
+        return false;
+
+    HistoryRecord r = {
+        .magic       = HISTORY_MAGIC,
+        .start       = s->start,
+        .day         = history_day(s->start),
+        .total_sec   = s->total_sec,
+        .work_sec    = s->work_sec,
+        .planned_sec = s->planned_sec,
+        .rounds      = s->rounds,
+        .completed   = s->completed,
+    };
+    r.checksum = record_checksum(&r);
+
+    ssize_t n = write(g_fd, &r, sizeof r);
+    if (n == (ssize_t)sizeof r)
+        return true;
+
+    fprintf(stderr, "history: %s\n", n == -1 ? strerror(errno) : "short write");
+    /* keep the file a whole number of records for the next append */
+    struct stat st;
+    if (n > 0 && fstat(g_fd, &st) == 0)
+        ftruncate(g_fd, st.st_size - n);
+    return false;
+}
+
+bool history_summarize(int32_t today, HistorySummary *out)
+{
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    const int32_t this_week = week_of(today);
+    *out = (HistorySummary){
+        .week0_day = (this_week - (HISTORY_WEEKS - 1)) * 7 - 3
+    };
+
+    struct stat st;
+    if (g_fd == -1 || fstat(g_fd, &st) == -1)
+        return false;
+    const size_t n = (size_t)st.st_size / sizeof(HistoryRecord);
+    if (n == 0)
+        return true;
+
+    void *map = mmap(NULL, n * sizeof(HistoryRecord), PROT_READ,
+                     MAP_PRIVATE, g_fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+    madvise(map, n * sizeof(HistoryRecord), MADV_SEQUENTIAL);
+
+    /* One pass.  Records are in the order sessions ended, so days only
+       go forward – except after a clock change, which the streak
+       simply does not count. */
+    const HistoryRecord *r = map;
+    int32_t last = INT32_MIN;           /* last day with a completed one */
+    unsigned int run = 0;
+    for (size_t i = 0; i < n; ++i, ++r) {
+        if (r->magic != HISTORY_MAGIC || r->checksum != record_checksum(r))
+            continue;
+
+        out->records++;
+        out->total_sec += r->total_sec;
+        out->work_sec  += r->work_sec;
+        out->rounds    += r->rounds;
+
+        const int32_t w = HISTORY_WEEKS - 1 - (this_week - week_of(r->day));
+        if (w >= 0 && w < HISTORY_WEEKS) {
+            out->week_work_sec[w] += r->work_sec;
+            out->week_sessions[w]++;
+        }
+
+        if (!r->completed)
+            continue;
+        out->completed++;
+        if (r->day <= last)
+            continue;
+        run = r->day == last + 1 ? run + 1 : 1;
+        last = r->day;
+        if (run > out->longest_streak_days)
+            out->longest_streak_days = run;
+    }
+    munmap(map, n * sizeof(HistoryRecord));
+    out->streak_days = last >= today - 1 ? run : 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    out->scan_us = (unsigned long)((t1.tv_sec - t0.tv_sec) * 1000000L +
+                                   (t1.tv_nsec - t0.tv_nsec) / 1000);
+    return true;
+}
+
+int32_t history_day(int64_t t)
+{
+    time_t tt = (time_t)t;
+    struct tm tm;
+    if (!localtime_r(&tt, &tm))
+        return 0;
+    const int64_t local = t + tm.tm_gmtoff;
+    return (int32_t)(local >= 0 ? local / 86400 : (local - 86399) / 86400);
+}
+
+void history_close(void)
+{
+    if (g_fd != -1) {
+        close(g_fd);
+        g_fd = -1;
+    }
+}
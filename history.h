@@ -0,0 +1,65 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/* -------------------------------------------------------------
+ *  Workout history: an append‑only file of fixed‑size records, one
+ *  per finished session.
+ *
+ *  An append is a single O_APPEND write(2) of one record – constant
+ *  time, no fsync(), the page cache survives the process like the
+ *  persist.c file.  A record that a crash left half written fails its
+ *  checksum and is skipped; a torn tail is cut off at the next open.
+ *
+ *  Queries map the file read‑only and make one sequential pass.  Each
+ *  record carries the local calendar day it started on, so days,
+ *  streaks and weeks are integer arithmetic – no time zone lookups
+ *  per record, however many years the file covers.
+ *
+ *  Single instance, handle‑less – like the audio API.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HISTORY_WEEKS 8         /* weeks reported, this one included */
+
+typedef struct {
+    int64_t  start;             /* wall clock, seconds since the epoch */
+    uint32_t total_sec;         /* how long the session ran            */
+    uint32_t work_sec;          /* of which work                       */
+    uint32_t planned_sec;       /* length of the whole program         */
+    uint32_t rounds;            /* work phases reached                 */
+    bool     completed;         /* ran to the end rather than stopped  */
+} HistorySession;
+
+typedef struct {
+    unsigned long records;      /* intact records scanned              */
+    unsigned long completed;
+    uint64_t      total_sec;
+    uint64_t      work_sec;
+    uint64_t      rounds;
+    unsigned int  streak_days;  /* days in a row with a completed
+                                   session, ending today or yesterday  */
+    unsigned int  longest_streak_days;
+    int32_t       week0_day;    /* Monday of the oldest week below     */
+    uint64_t      week_work_sec[HISTORY_WEEKS];  /* oldest first       */
+    unsigned int  week_sessions[HISTORY_WEEKS];
+    unsigned long scan_us;      /* time taken by the pass              */
+} HistorySummary;
+
+/* Open – creating if need be – the history file at ‘path’.  A symlink,
+ * or a file that does not start with a history record, is refused and
+ * left as it is. */
+bool history_open(const char *path);
+
+/* Append one session. */
+bool history_append(const HistorySession *s);
+
+/* Aggregate the whole file as of local day ‘today’ (history_day()). */
+bool history_summarize(int32_t today, HistorySummary *out);
+
+/* Local calendar day of wall‑clock time ‘t’, in days since 1970‑01‑01. */
+int32_t history_day(int64_t t);
+
+void history_close(void);
+
+#endif /* HISTORY_H */
@@ -0,0 +1,158 @@
+/* mkpack.c
+ *
+ * Build an asset pack (see asset_pack.h) from a set of WAV files.
+ *
+ * Usage:
+ *   mkpack <out.pack> <file.wav>...
+ *
+ * The asset name is the file's basename without ".wav", exactly like
+ * the names used with the embedded table ("num12", "round", …).
+ * The output is written to <out.pack>.tmp and renamed into place, so a
+ * running daemon can be SIGHUP'ed at any time without seeing a partial
+ * file.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "asset_pack.h"
+
+typedef struct {
+    const char *path;
+    char        name[ASSET_PACK_NAME_MAX];
+    uint64_t    size;
+} Input;
+
+static int input_cmp(const void *a, const void *b)
+{
+    return strcmp(((const Input *)a)->name, ((const Input *)b)->name);
+}
+
+static uint64_t align_up(uint64_t v)
+{
+    return (v + ASSET_PACK_ALIGN - 1) / ASSET_PACK_ALIGN * ASSET_PACK_ALIGN;
+}
+
+static bool write_zeros(FILE *out, uint64_t n)
+{
+    static const unsigned char zero[ASSET_PACK_ALIGN];
+    while (n > 0) {
+        size_t chunk = n < sizeof zero ? (size_t)n : sizeof zero;
+        if (fwrite(zero, 1, chunk, out) != chunk)
+            return false;
+        n -= chunk;
+    }
+    return true;
+}
+
+static bool copy_file(FILE *out, const char *path)
+{
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+    char buf[1 << 16];
+    size_t n;
+    bool ok = true;
+    while ((n = fread(buf, 1, sizeof buf, in)) > 0)
+        if (fwrite(buf, 1, n, out) != n) { ok = false; break; }
+    if (ferror(in))
+        ok = false;
+    fclose(in);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <out.pack> <file.wav>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t count = (size_t)argc - 2;
+    Input *in = calloc(count, sizeof *in);
+    if (!in) { perror("calloc"); return EXIT_FAILURE; }
+
+    for (size_t i = 0; i < count; ++i) {
+        const char *path = argv[i + 2];
+        const char *base = strrchr(path, '/');
+        base = base ? base + 1 : path;
+        size_t len = strlen(base);
+        if (len > 4 && strcmp(base + len - 4, ".wav") == 0)
+            len -= 4;
+        if (len == 0 || len >= ASSET_PACK_NAME_MAX) {
+            fprintf(stderr, "%s: bad asset name\n", path);
+            return EXIT_FAILURE;
+        }
+        memcpy(in[i].name, base, len);
+        in[i].path = path;
+
+        FILE *f = fopen(path, "rb");
+        if (!f || fseek(f, 0, SEEK_END) != 0) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        in[i].size = (uint64_t)ftell(f);
+        fclose(f);
+    }
+
+    qsort(in, count, sizeof *in, input_cmp);
+    for (size_t i = 1; i < count; ++i) {
+        if (strcmp(in[i - 1].name, in[i].name) == 0) {
+            fprintf(stderr, "duplicate asset name: %s\n", in[i].name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* ---------- lay the file out ---------- */
+    AssetPackHeader hdr = { .version = ASSET_PACK_VERSION,
+                            .count   = (uint32_t)count };
+    memcpy(hdr.magic, ASSET_PACK_MAGIC, sizeof hdr.magic);
+    hdr.index_offset = sizeof hdr;
+    hdr.data_offset  = align_up(hdr.index_offset +
+                                count * sizeof(AssetPackEntry));
+
+    AssetPackEntry *index = calloc(count, sizeof *index);
+    if (!index) { perror("calloc"); return EXIT_FAILURE; }
+
+    uint64_t off = hdr.data_offset;
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(index[i].name, in[i].name, sizeof index[i].name);
+        index[i].offset = off;
+        index[i].size   = in[i].size;
+        off = align_up(off + in[i].size);
+    }
+    hdr.file_size = off;
+
+    /* ---------- write it ---------- */
+    char tmp[4096];
+    snprintf(tmp, sizeof tmp, "%s.tmp", argv[1]);
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        fprintf(stderr, "%s: %s\n", tmp, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    bool ok = fwrite(&hdr, sizeof hdr, 1, out) == 1 &&
+              fwrite(index, sizeof *index, count, out) == count &&
+              write_zeros(out, hdr.data_offset - hdr.index_offset -
+                               count * sizeof *index);
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = copy_file(out, in[i].path) &&
+             write_zeros(out, align_up(in[i].size) - in[i].size);
+    }
+    if (fclose(out) != 0)
+        ok = false;
+
+    if (!ok || rename(tmp, argv[1]) == -1) {
+        fprintf(stderr, "%s: write failed\n", argv[1]);
+        remove(tmp);
+        return EXIT_FAILURE;
+    }
+
+    free(index);
+    free(in);
+    return EXIT_SUCCESS;
+}
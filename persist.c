@@ -0,0 +1,156 @@
+/*=====================================================================
+ *  persist.c  –  crash‑safe double‑slot record file (see persist.h)
+ *====================================================================*/
+#define _POSIX_C_SOURCE 200809L
+#include "persist.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PERSIST_MAGIC "CBTSTAT1"
+
+typedef struct {
+    uint64_t seq;                        /* 0 = never written          */
+    uint32_t len;                        /* payload bytes              */
+    uint32_t checksum;                   /* over seq, len and payload  */
+    unsigned char payload[PERSIST_MAX_PAYLOAD];
+} PersistSlot;
+
+typedef struct {
+    char        magic[8];
+    PersistSlot slot[2];
+} PersistFile;
+
+static PersistFile *g_file = NULL;
+static size_t       g_payload_size = 0;
+
+/* FNV‑1a – cheap, and only has to catch torn writes */
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t slot_checksum(const PersistSlot *s)
+{
+    uint32_t h = 2166136261u;
+    h = fnv1a(h, &s->seq, sizeof s->seq);
+    h = fnv1a(h, &s->len, sizeof s->len);
+    return fnv1a(h, s->payload, s->len <= PERSIST_MAX_PAYLOAD ? s->len : 0);
+}
+
+static bool slot_valid(const PersistSlot *s)
+{
+    return s->seq != 0 &&
+           s->len == g_payload_size &&
+           s->checksum == slot_checksum(s);
+}
+
+/* Index of the newest intact slot, or -1 */
+static int newest_slot(void)
+{
+    bool v0 = slot_valid(&g_file->slot[0]);
+    bool v1 = slot_valid(&g_file->slot[1]);
+    if (v0 && v1)
+        return g_file->slot[1].seq > g_file->slot[0].seq;
+    return v0 ? 0 : v1 ? 1 : -1;
+}
+
+/*=====================================================================
+ *  PUBLIC API
+ *====================================================================*/
+bool persist_open(const char *path, size_t payload_size)
+{
+    if (payload_size > PERSIST_MAX_PAYLOAD)
+        return false;
+
+    /* Never through a symlink, and never over someone else's file: only
+       an empty one is made into a state file. */
+    int fd = open(path, O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        fprintf(stderr, "persist: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 ||
+        (st.st_size == 0 && ftruncate(fd, sizeof(PersistFile)) == -1)) {
+        fprintf(stderr, "persist: %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    const bool fresh = st.st_size == 0;
+    if (!S_ISREG(st.st_mode) ||
+        (!fresh && (size_t)st.st_size != sizeof(PersistFile))) {
+        fprintf(stderr, "persist: %s: not a state file, left alone\n", path);
+        close(fd);
+        return false;
+    }
+
+    void *p = mmap(NULL, sizeof(PersistFile), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    PersistFile *f = p;
+    if (fresh) {
+        memcpy(f->magic, PERSIST_MAGIC, sizeof f->magic);
+    } else if (memcmp(f->magic, PERSIST_MAGIC, sizeof f->magic) != 0) {
+        fprintf(stderr, "persist: %s: not a state file, left alone\n", path);
+        munmap(p, sizeof(PersistFile));
+        return false;
+    }
+    g_file = f;
+    g_payload_size = payload_size;
+    return true;
+}
+
+bool persist_load(void *payload)
+{
+    if (!g_file)
+        return false;
+    int i = newest_slot();
+    if (i < 0)
+        return false;
+    memcpy(payload, g_file->slot[i].payload, g_payload_size);
+    return true;
+}
+
+void persist_store(const void *payload)
+{
+    if (!g_file)
+        return;
+
+    int cur = newest_slot();
+    uint64_t seq = cur < 0 ? 1 : g_file->slot[cur].seq + 1;
+    PersistSlot *s = &g_file->slot[cur == 0 ? 1 : 0];
+
+    /* Invalidate first, publish the checksum last: until the final
+       store lands this slot never validates, so the other one wins. */
+    __atomic_store_n(&s->checksum, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->seq = seq;
+    s->len = (uint32_t)g_payload_size;
+    memcpy(s->payload, payload, g_payload_size);
+    __atomic_store_n(&s->checksum, slot_checksum(s), __ATOMIC_RELEASE);
+}
+
+void persist_close(void)
+{
+    if (g_file) {
+        munmap(g_file, sizeof *g_file);
+        g_file = NULL;
+    }
+}
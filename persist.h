@@ -0,0 +1,35 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+/* -------------------------------------------------------------
+ *  Crash‑safe, mmap‑backed record file.
+ *
+ *  The file holds two slots.  Every store goes to the slot *not*
+ *  holding the newest record, stamped with the next sequence number
+ *  and a checksum, so a process dying in the middle of a store leaves
+ *  the previous record intact.  Stores are plain memory writes into a
+ *  MAP_SHARED page – no msync()/fsync(), the page cache survives the
+ *  process – which keeps them cheap enough for the tick path.
+ *
+ *  Single instance, handle‑less – like the audio API.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PERSIST_MAX_PAYLOAD 256
+
+/* Create / map the file at ‘path’ for records of ‘payload_size’ bytes.
+ * A symlink, or an existing file that is not a state file, is refused
+ * and left as it is. */
+bool persist_open(const char *path, size_t payload_size);
+
+/* Copy the newest intact record into ‘payload’; false if there is none
+ * (fresh file, different payload size, or both slots damaged). */
+bool persist_load(void *payload);
+
+/* Write a new record. */
+void persist_store(const void *payload);
+
+void persist_close(void);
+
+#endif /* PERSIST_H */
@@ -0,0 +1,333 @@
+/*=====================================================================
+ *  program.c  –  interval program compiler and lookup (see program.h)
+ *====================================================================*/
+#define _POSIX_C_SOURCE 200809L
+#include "program.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+
+/* -----------------------------------------------------------------
+ *  Compiled form: two parallel arrays, so the binary search only
+ *  touches the 4‑byte end times.  ‘works’ counts the work phases up
+ *  to and including each phase, which gives the round number and
+ *  survives repeat expansion as a plain offset.
+ * ----------------------------------------------------------------- */
+typedef struct {
+    uint32_t *end;
+    uint32_t *works;
+    uint8_t  *work;
+    uint32_t  count;
+    uint32_t  cap;
+} Program;
+
+static Program g_prog = { NULL, NULL, NULL, 0, 0 };
+static char    g_prog_path[PATH_MAX];
+
+static void prog_release(Program *p)
+{
+    free(p->end);
+    free(p->works);
+    free(p->work);
+    memset(p, 0, sizeof *p);
+}
+
+static bool prog_reserve(Program *p, uint64_t n)
+{
+    if (n <= p->cap)
+        return true;
+    if (n > PROGRAM_MAX_PHASES)
+        return false;
+
+    uint64_t cap = p->cap ? p->cap : 64;
+    while (cap < n)
+        cap *= 2;
+    if (cap > PROGRAM_MAX_PHASES)
+        cap = PROGRAM_MAX_PHASES;
+
+    uint32_t *end   = realloc(p->end,   cap * sizeof *end);
+    if (end)   p->end = end;
+    uint32_t *works = realloc(p->works, cap * sizeof *works);
+    if (works) p->works = works;
+    uint8_t  *work  = realloc(p->work,  cap * sizeof *work);
+    if (work)  p->work = work;
+    if (!end || !works || !work)
+        return false;
+
+    p->cap = (uint32_t)cap;
+    return true;
+}
+
+static uint32_t prog_total(const Program *p)
+{
+    return p->count ? p->end[p->count - 1] : 0;
+}
+
+static uint32_t prog_works(const Program *p)
+{
+    return p->count ? p->works[p->count - 1] : 0;
+}
+
+static bool prog_add(Program *p, bool work, uint32_t sec)
+{
+    if (sec == 0)
+        return true;
+    uint64_t end = (uint64_t)prog_total(p) + sec;
+    if (end > UINT32_MAX || !prog_reserve(p, (uint64_t)p->count + 1))
+        return false;
+
+    p->end[p->count]   = (uint32_t)end;
+    p->works[p->count] = prog_works(p) + work;
+    p->work[p->count]  = work;
+    p->count++;
+    return true;
+}
+
+/* Append ‘times’ more copies of phases [first, count) */
+static bool prog_repeat(Program *p, uint32_t first, uint32_t times)
+{
+    const uint32_t n = p->count - first;
+    if (n == 0 || times == 0)
+        return true;
+
+    const uint32_t t0 = first ? p->end[first - 1] : 0;
+    const uint32_t w0 = first ? p->works[first - 1] : 0;
+    const uint64_t dur = prog_total(p) - t0;
+    const uint64_t wrk = prog_works(p) - w0;
+
+    if ((uint64_t)prog_total(p) + dur * times > UINT32_MAX ||
+        !prog_reserve(p, (uint64_t)p->count + (uint64_t)n * times))
+        return false;
+
+    for (uint32_t k = 1; k <= times; ++k) {
+        for (uint32_t i = 0; i < n; ++i) {
+            const uint32_t s = first + i;
+            const uint32_t d = p->count;
+            p->end[d]   = p->end[s]   + (uint32_t)(dur * k);
+            p->works[d] = p->works[s] + (uint32_t)(wrk * k);
+            p->work[d]  = p->work[s];
+            p->count++;
+        }
+    }
+    return true;
+}
+
+static void activate(Program *p, const char *path)
+{
+    prog_release(&g_prog);
+    g_prog = *p;
+    snprintf(g_prog_path, sizeof(g_prog_path), "%s", path);
+}
+
+/*=====================================================================
+ *  Parser
+ *====================================================================*/
+static void set_err(char *err, size_t errlen, const char *fmt, ...)
+{
+    if (!err || errlen == 0)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(err, errlen, fmt, ap);
+    va_end(ap);
+}
+
+/* "90" or "1:30" */
+static bool parse_duration(const char *s, uint32_t *sec)
+{
+    char *e;
+    errno = 0;
+    unsigned long v = strtoul(s, &e, 10);
+    if (e == s || errno)
+        return false;
+    if (*e == ':') {
+        const char *ss = e + 1;
+        unsigned long secs = strtoul(ss, &e, 10);
+        if (e - ss != 2 || secs > 59 || errno)
+            return false;
+        v = v * 60 + secs;
+    }
+    if (*e != '\0' || v > UINT32_MAX)
+        return false;
+    *sec = (uint32_t)v;
+    return true;
+}
+
+static bool parse_count(const char *s, uint32_t *n)
+{
+    char *e;
+    errno = 0;
+    unsigned long v = strtoul(s, &e, 10);
+    if (e == s || *e != '\0' || errno || v == 0 || v > PROGRAM_MAX_PHASES)
+        return false;
+    *n = (uint32_t)v;
+    return true;
+}
+
+bool program_compile_file(const char *path, char *err, size_t errlen)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        set_err(err, errlen, "%s: %s", path, strerror(errno));
+        return false;
+    }
+
+    Program p = { 0 };
+    struct { uint32_t first, times, line; } stack[PROGRAM_MAX_DEPTH];
+    int depth = 0;
+    unsigned line = 0;
+    bool ok = true;
+    char *buf = NULL;
+    size_t cap = 0;
+
+    while (ok && getline(&buf, &cap, f) != -1) {
+        ++line;
+        buf[strcspn(buf, "#")] = '\0';
+
+        char *save = NULL;
+        char *kw  = strtok_r(buf,  " \t\r\n", &save);
+        char *arg = strtok_r(NULL, " \t\r\n", &save);
+        char *xtra = strtok_r(NULL, " \t\r\n", &save);
+        if (!kw)
+            continue;
+
+        uint32_t v;
+        if (xtra) {
+            set_err(err, errlen, "line %u: unexpected '%s'", line, xtra);
+            ok = false;
+        } else if (!strcasecmp(kw, "work") || !strcasecmp(kw, "rest")) {
+            if (!arg || !parse_duration(arg, &v)) {
+                set_err(err, errlen, "line %u: bad duration", line);
+                ok = false;
+            } else if (!prog_add(&p, tolower((unsigned char)kw[0]) == 'w', v)) {
+                set_err(err, errlen, "line %u: program too long", line);
+                ok = false;
+            }
+        } else if (!strcasecmp(kw, "repeat")) {
+            if (!arg || !parse_count(arg, &v)) {
+                set_err(err, errlen, "line %u: bad repeat count", line);
+                ok = false;
+            } else if (depth == PROGRAM_MAX_DEPTH) {
+                set_err(err, errlen, "line %u: repeats nested too deep", line);
+                ok = false;
+            } else {
+                stack[depth].first = p.count;
+                stack[depth].times = v;
+                stack[depth].line  = line;
+                depth++;
+            }
+        } else if (!strcasecmp(kw, "end") && !arg) {
+            if (depth == 0) {
+                set_err(err, errlen, "line %u: 'end' without 'repeat'", line);
+                ok = false;
+            } else {
+                depth--;
+                if (!prog_repeat(&p, stack[depth].first,
+                                 stack[depth].times - 1)) {
+                    set_err(err, errlen, "line %u: program too long", line);
+                    ok = false;
+                }
+            }
+        } else {
+            set_err(err, errlen, "line %u: unknown statement '%s'", line, kw);
+            ok = false;
+        }
+    }
+    free(buf);
+    fclose(f);
+
+    if (ok && depth) {
+        set_err(err, errlen, "line %u: 'repeat' without 'end'",
+                stack[depth - 1].line);
+        ok = false;
+    }
+    if (ok && p.count == 0) {
+        set_err(err, errlen, "%s: no intervals", path);
+        ok = false;
+    }
+    if (!ok) {
+        prog_release(&p);
+        return false;
+    }
+
+    activate(&p, path);
+    return true;
+}
+
+bool program_compile_tabata(int work_sec, int rest_sec, int rounds)
+{
+    if (work_sec <= 0 || rest_sec < 0 || rounds <= 0)
+        return false;
+
+    Program p = { 0 };
+    if (!prog_add(&p, true, (uint32_t)work_sec) ||
+        !prog_add(&p, false, (uint32_t)rest_sec) ||
+        !prog_repeat(&p, 0, (uint32_t)rounds - 1)) {
+        prog_release(&p);
+        return false;
+    }
+    activate(&p, "");
+    return true;
+}
+
+void program_free(void)
+{
+    prog_release(&g_prog);
+    g_prog_path[0] = '\0';
+}
+
+/*=====================================================================
+ *  Queries
+ *====================================================================*/
+uint32_t program_phases(void)    { return g_prog.count; }
+uint32_t program_rounds(void)    { return prog_works(&g_prog); }
+uint32_t program_total_sec(void) { return prog_total(&g_prog); }
+const char *program_path(void)   { return g_prog_path; }
+
+bool program_phase(uint32_t index, ProgramPos *pos)
+{
+    if (index >= g_prog.count)
+        return false;
+
+    const uint32_t works = g_prog.works[index];
+    pos->index = index;
+    pos->work  = g_prog.work[index];
+    pos->round = works ? works - 1 : 0;
+    pos->start = index ? g_prog.end[index - 1] : 0;
+    pos->end   = g_prog.end[index];
+    return true;
+}
+
+uint32_t program_work_sec(uint32_t t, uint32_t *rounds)
+{
+    uint32_t sec = 0, start = 0;
+    *rounds = 0;
+    for (uint32_t i = 0; i < g_prog.count && start < t; ++i) {
+        const uint32_t end = g_prog.end[i];
+        if (g_prog.work[i]) {
+            sec += (end < t ? end : t) - start;
+            (*rounds)++;
+        }
+        start = end;
+    }
+    return sec;
+}
+
+bool program_locate(uint32_t t, ProgramPos *pos)
+{
+    /* first phase that ends after t */
+    uint32_t lo = 0, hi = g_prog.count;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (g_prog.end[mid] <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return program_phase(lo, pos);
+}
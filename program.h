@@ -0,0 +1,75 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+/* -------------------------------------------------------------
+ *  Interval programs.
+ *
+ *  A program is a list of work/rest phases, compiled once into an
+ *  array of cumulative phase end times (seconds from the start).
+ *  Where a session is at any moment is then a binary search over
+ *  that array, so a program of many thousand intervals costs no more
+ *  per query than a plain tabata.
+ *
+ *  Program files are plain text, one statement per line:
+ *
+ *      # warm‑up
+ *      rest 2:00
+ *      repeat 8          # classic tabata
+ *        work 20
+ *        rest 10
+ *      end
+ *      repeat 10         # ladder blocks may nest
+ *        work 1:00
+ *        rest 30
+ *      end
+ *
+ *  Durations are seconds or m:ss; a zero duration adds no phase.
+ *  Every work phase is a round – the N in "round X of N".
+ *
+ *  Single instance, handle‑less – like the audio API.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROGRAM_MAX_PHASES  (1u << 20)
+#define PROGRAM_MAX_DEPTH   16          /* nested repeat blocks */
+
+typedef struct {
+    uint32_t index;     /* phase number                              */
+    uint32_t round;     /* 0‑based; a rest belongs to the work before */
+    bool     work;      /* work or rest phase                        */
+    uint32_t start;     /* seconds from program start                */
+    uint32_t end;       /* first second after the phase              */
+} ProgramPos;
+
+/* Make "work_sec / rest_sec, ‘rounds’ times" the active program. */
+bool program_compile_tabata(int work_sec, int rest_sec, int rounds);
+
+/* Compile the file at ‘path’ and make it the active program.  On
+ * failure a message (with the line number) goes to ‘err’ and the
+ * active program stays in place. */
+bool program_compile_file(const char *path, char *err, size_t errlen);
+
+void program_free(void);
+
+uint32_t program_phases(void);
+uint32_t program_rounds(void);
+uint32_t program_total_sec(void);
+
+/* The file the active program came from, "" for a tabata. */
+const char *program_path(void);
+
+/* The phase running ‘t’ seconds into the program; false once it has
+ * finished.  O(log n). */
+bool program_locate(uint32_t t, ProgramPos *pos);
+
+/* Phase number ‘index’; false past the last one. */
+bool program_phase(uint32_t index, ProgramPos *pos);
+
+/* Seconds of work in the first ‘t’ seconds of the program, and in
+ * ‘rounds’ the work phases begun by then.  O(n) – for the end of a
+ * session, not every tick. */
+uint32_t program_work_sec(uint32_t t, uint32_t *rounds);
+
+#endif /* PROGRAM_H */
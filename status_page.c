@@ -0,0 +1,80 @@
+/*=====================================================================
+ *  status_page.c  –  seqlock writer for the status page (see
+ *                    status_page.h)
+ *====================================================================*/
+#define _POSIX_C_SOURCE 200809L
+#include "status_page.h"
+#include <stdio.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+static StatusPage *g_page = NULL;
+static char        g_name[64];
+
+bool status_page_create(const char *name)
+{
+    snprintf(g_name, sizeof(g_name), "%s", name ? name : STATUS_PAGE_NAME);
+
+    /* A crashed daemon may have left one behind – start clean */
+    shm_unlink(g_name);
+
+    int fd = shm_open(g_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "status page: %s\n", strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, STATUS_PAGE_SIZE) == -1) {
+        fprintf(stderr, "status page: %s\n", strerror(errno));
+        close(fd);
+        shm_unlink(g_name);
+        return false;
+    }
+
+    void *p = mmap(NULL, STATUS_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(g_name);
+        return false;
+    }
+
+    g_page = p;
+    g_page->version = STATUS_PAGE_VERSION;
+    /* The magic goes in last: readers reject the page until it is set */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(g_page->magic, STATUS_PAGE_MAGIC, sizeof g_page->magic);
+    return true;
+}
+
+void status_page_publish(const StatusData *d)
+{
+    if (!g_page)
+        return;
+
+    const uint64_t *src = (const uint64_t *)d;
+    uint64_t *dst = (uint64_t *)&g_page->data;
+    const uint64_t seq = g_page->seq;          /* single writer */
+
+    __atomic_store_n(&g_page->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0; i < STATUS_WORDS; ++i)
+        __atomic_store_n(&dst[i], src[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&g_page->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* Leave a final "idle, no daemon" snapshot for readers that still have
+   the page mapped, then remove the name. */
+void status_page_destroy(void)
+{
+    if (!g_page)
+        return;
+
+    StatusData idle = { 0 };
+    idle.updates = g_page->data.updates + 1;
+    status_page_publish(&idle);
+
+    munmap(g_page, STATUS_PAGE_SIZE);
+    g_page = NULL;
+    shm_unlink(g_name);
+}
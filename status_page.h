@@ -0,0 +1,126 @@
+#ifndef STATUS_PAGE_H
+#define STATUS_PAGE_H
+
+/* -------------------------------------------------------------
+ *  Shared‑memory status page.
+ *
+ *  The daemon publishes the timer state to the POSIX shared memory
+ *  object STATUS_PAGE_NAME (or the name in CABATA_SHM), one page,
+ *  world readable.  Readers map it read‑only and take consistent
+ *  snapshots with a seqlock: the daemon makes ‘seq’ odd while it
+ *  writes and even again when done, a reader retries whenever ‘seq’
+ *  was odd or moved under it.  A read is a few loads – no syscall, no
+ *  socket, no daemon wakeup – so bars and widgets can poll it at
+ *  display rate.
+ *
+ *  The reader side is header‑only, include this file and use
+ *  status_page_map() / status_page_read():
+ *
+ *      const StatusPage *pg = status_page_map(NULL);
+ *      StatusData d;
+ *      if (pg && status_page_read(pg, &d) && d.running)
+ *          printf("%lld ms left\n", (long long)status_page_ms_left(&d));
+ *
+ *  The writer side is status_page.c, used by the daemon only.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define STATUS_PAGE_NAME     "/cabata-status"
+#define STATUS_PAGE_MAGIC    "CBTSHM01"
+#define STATUS_PAGE_VERSION  1u
+#define STATUS_PAGE_SIZE     4096u
+
+/* Every field is 64 bit, so snapshots are copied word by word */
+typedef struct {
+    int64_t  pid;            /* daemon; 0 once it exited cleanly       */
+    uint64_t running;        /* 0 = idle                               */
+    uint64_t work;           /* work (1) or rest (0) phase             */
+    uint64_t round;          /* 1‑based, as spoken                     */
+    uint64_t rounds;
+    uint64_t phase;          /* 0‑based phase index in the program     */
+    uint64_t phases;
+    uint64_t sec_remaining;  /* as of the last tick                    */
+    int64_t  phase_end_ns;   /* CLOCK_BOOTTIME deadline of the phase   */
+    uint64_t updates;        /* publications so far                    */
+} StatusData;
+
+typedef struct {
+    char       magic[8];     /* STATUS_PAGE_MAGIC, not NUL terminated  */
+    uint32_t   version;      /* STATUS_PAGE_VERSION                    */
+    uint32_t   pad;
+    uint64_t   seq;          /* odd while the daemon is writing        */
+    StatusData data;
+} StatusPage;
+
+#define STATUS_WORDS (sizeof(StatusData) / sizeof(uint64_t))
+
+/* -----------------------------------------------------------------
+ *  Reader
+ * ----------------------------------------------------------------- */
+
+/* Map the page ‘name’ (NULL: STATUS_PAGE_NAME) read‑only; NULL when
+ * no daemon ever published one.  The mapping stays valid for the life
+ * of the process. */
+static inline const StatusPage *status_page_map(const char *name)
+{
+    int fd = shm_open(name ? name : STATUS_PAGE_NAME, O_RDONLY, 0);
+    if (fd == -1)
+        return NULL;
+    void *p = mmap(NULL, STATUS_PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    const StatusPage *pg = p;
+    if (memcmp(pg->magic, STATUS_PAGE_MAGIC, sizeof pg->magic) != 0 ||
+        pg->version != STATUS_PAGE_VERSION) {
+        munmap(p, STATUS_PAGE_SIZE);
+        return NULL;
+    }
+    return pg;
+}
+
+/* Copy a consistent snapshot; false if the writer kept it busy for
+ * too long (it only holds it for a few stores, so this is rare). */
+static inline bool status_page_read(const StatusPage *pg, StatusData *out)
+{
+    const uint64_t *src = (const uint64_t *)&pg->data;
+    uint64_t *dst = (uint64_t *)out;
+
+    for (int tries = 0; tries < 1000; ++tries) {
+        uint64_t s0 = __atomic_load_n(&pg->seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1)
+            continue;
+        for (size_t i = 0; i < STATUS_WORDS; ++i)
+            dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&pg->seq, __ATOMIC_RELAXED) == s0)
+            return true;
+    }
+    return false;
+}
+
+/* Time to the end of the phase, from the deadline rather than the
+ * last tick, so it moves smoothly between ticks. */
+static inline int64_t status_page_ms_left(const StatusData *d)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    int64_t now = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    return d->phase_end_ns > now ? (d->phase_end_ns - now) / 1000000 : 0;
+}
+
+/* -----------------------------------------------------------------
+ *  Writer (status_page.c – daemon only)
+ * ----------------------------------------------------------------- */
+bool status_page_create(const char *name);
+void status_page_publish(const StatusData *d);
+void status_page_destroy(void);
+
+#endif /* STATUS_PAGE_H */
@@ -4,15 +4,58 @@
  *
  * Usage (client):
  *   tabata_timer start   <work_sec> <rest_sec> <rounds>
+ *   tabata_timer program <file>      # interval program, see program.h
  *   tabata_timer stop
  *   tabata_timer status
+ *   tabata_timer status --shm  # read the status page, daemon untouched
+ *   tabata_timer next        # what the next phase is and when
+ *   tabata_timer stats       # daemon performance counters
+ *   tabata_timer history     # totals, streaks and recent weeks
+ *   tabata_timer trace dump  # recent events as Chrome trace JSON
  *   tabata_timer quit        # ask daemon to exit
  *
  *   If the daemon is not running it will be started automatically.
+ *   The client half lives in client.c, which also builds "cabatac", a
+ *   client without the audio libraries and the embedded WAVs.
+ *
+ *   CABATA_PACK=<file>      voice asset pack to use instead of the
+ *                           embedded WAVs (build one with mkpack);
+ *                           SIGHUP makes the daemon reload it.
+ *   CABATA_RT=<1‑99>        play at that SCHED_FIFO priority and mlock
+ *                           the audio memory (falls back gracefully
+ *                           without CAP_SYS_NICE / CAP_IPC_LOCK); 0 or
+ *                           unset is off.
+ *   CABATA_PERIOD_MS_MIN=n  bounds for the ALSA period, which grows on
+ *   CABATA_PERIOD_MS_MAX=n  repeated underruns and shrinks when stable
+ *                           (defaults 10 and 80 ms; buffer = 4 periods,
+ *                           or a whole countdown cue if that is more).
+ *   CABATA_STREAM=1         start playing the first clip of an
+ *                           announcement while later ones are decoded.
+ *   CABATA_GAIN=<pct>       output volume (default 100, up to 199)
+ *   CABATA_DUCK=<pct>       volume of the random messages relative to
+ *                           the cues (default 50, up to 100)
+ *   CABATA_FADE_MS=<ms>     de‑click fade at every clip join (default 5,
+ *                           up to 1000)
+ *   CABATA_COUNTDOWN=<n>    count the last n seconds (up to 10) of
+ *                           every phase down aloud
+ *   CABATA_AUDIO=null       discard all audio (benchmarks, headless tests)
+ *   CABATA_DEVICES="a b"    ALSA PCMs to play on (default "default");
+ *                           several play the same stream, one writer
+ *                           thread each – see audio.h.
+ *   CABATA_SOCK=<path>      control socket (default SOCK_PATH, client.h)
+ *   CABATA_STATE=<path>     session state file (default
+ *                           $XDG_RUNTIME_DIR/cabata.state, else
+ *                           ~/.cabata_state)
+ *   CABATA_HISTORY=<path>   workout history (default ~/.cabata_history)
+ *   CABATA_SHM=</name>      status page (default /cabata-status); with
+ *                           these a second daemon, e.g. a benchmark's,
+ *                           can run beside the real one.
  *
  * The daemon runs in the background after being exec‑ed with "--daemon".
  * It ticks once per second (using timerfd) and guarantees that missed
- * ticks are accounted for.
+ * ticks are accounted for.  The session is mirrored to the state file,
+ * so a daemon that died is resumed where the workout is *now* by the
+ * next one to start.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -30,30 +73,53 @@
 #include <sys/wait.h>
 #include <sys/timerfd.h>
 #include <sys/select.h>
+#include <sys/resource.h>
 #include <signal.h>
 #include <time.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <limits.h>
 //For playing audio
 #include "audio.h"
+#include "asset_pack.h"
+#include "persist.h"
+#include "program.h"
+#include "status_page.h"
+#include "trace.h"
+#include "client.h"
+#include "history.h"
+#include "env.h"
+
 
+#define STATE_FILE    "cabata.state"              // in $XDG_RUNTIME_DIR
+#define STATE_DOTFILE ".cabata_state"             // in $HOME without one
+#define STATE_PATH    "/tmp/tabata_timer.state"   // without either
+#define HISTORY_FILE  ".cabata_history"           // in $HOME
+#define HISTORY_PATH  "/tmp/tabata_timer.history" // without a $HOME
 
-#define SOCK_PATH   "/tmp/tabata_timer.sock"
-#define MAX_CMD_LEN 256
+/* Overridable through CABATA_SOCK / CABATA_STATE / CABATA_SHM /
+   CABATA_HISTORY */
+static const char *sock_path    = SOCK_PATH;
+static const char *state_path   = STATE_PATH;
+static const char *shm_name     = STATUS_PAGE_NAME;
+static const char *history_path = HISTORY_PATH;
 
 /* ----------------------------------------------------------------------
    Daemon state
    ---------------------------------------------------------------------- */
 typedef enum { IDLE, RUNNING } daemon_state_t;
 
+/* The phases themselves live in the compiled program (program.c);
+   the timer only tracks how far into it the session is. */
 typedef struct {
     daemon_state_t state;
-    int work_sec;      // length of work interval
-    int rest_sec;      // length of rest interval
-    int rounds;        // total number of rounds
-    int cur_round;     // 0‑based index of current round
-    bool in_work;      // true = work phase, false = rest phase
+    int work_sec;      // "start" parameters, kept to rebuild the program
+    int rest_sec;
+    int rounds;
+    uint32_t elapsed;  // seconds since the program started
+    ProgramPos phase;  // phase containing ‘elapsed’
     int sec_remaining; // seconds left in current phase
+    int64_t start_ns;  // CLOCK_BOOTTIME when the program started
 } tabata_tabata_timer_t;
 
 static tabata_tabata_timer_t timer = {
@@ -61,17 +127,202 @@ static tabata_tabata_timer_t timer = {
     .work_sec = 0,
     .rest_sec = 0,
     .rounds = 0,
-    .cur_round = 0,
-    .in_work = true,
-    .sec_remaining = 0
+    .elapsed = 0,
+    .sec_remaining = 0,
+    .start_ns = 0
 };
 
+/* ----------------------------------------------------------------------
+   Crash‑safe session state: every start and stop is written to a small
+   mmap'ed record file (persist.c).  The program is kept by how it was
+   made plus its CLOCK_BOOTTIME start, so a restarted daemon can tell
+   where the session is now, however long it was gone – suspend
+   included.
+   ---------------------------------------------------------------------- */
+typedef struct {
+    char     boot_id[40];  // start times only mean something within a boot
+    uint8_t  running;
+    int32_t  work_sec;     // "start" sessions
+    int32_t  rest_sec;
+    int32_t  rounds;
+    uint32_t phases;       // to notice a program file that changed
+    uint32_t total_sec;
+    int64_t  start_ns;     // CLOCK_BOOTTIME
+    char     program[160]; // "program" sessions: absolute file path
+} timer_snapshot_t;
+
+static char boot_id[40];
+
+static int64_t boottime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void read_boot_id(void)
+{
+    FILE *f = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (f) {
+        if (fgets(boot_id, sizeof(boot_id), f))
+            boot_id[strcspn(boot_id, "\n")] = '\0';
+        fclose(f);
+    }
+}
+
+/* Record the current session – cheap, no fsync */
+static void save_timer(void)
+{
+    timer_snapshot_t snap = {0};
+    const char *path = program_path();
+
+    memcpy(snap.boot_id, boot_id, sizeof(snap.boot_id));
+    /* a path that does not fit cannot be resumed – record it as idle */
+    snap.running   = timer.state == RUNNING &&
+                     strlen(path) < sizeof(snap.program);
+    snap.work_sec  = timer.work_sec;
+    snap.rest_sec  = timer.rest_sec;
+    snap.rounds    = timer.rounds;
+    snap.phases    = program_phases();
+    snap.total_sec = program_total_sec();
+    snap.start_ns  = timer.start_ns;
+    if (snap.running)
+        strcpy(snap.program, path);
+    persist_store(&snap);
+}
+
+/* Pick up a session the previous daemon left running: rebuild its
+   program and look up where it is now.  Phases that ended while no
+   daemon was around are skipped silently.  Returns true when the
+   session is still running. */
+static bool recover_timer(void)
+{
+    timer_snapshot_t snap;
+    if (!persist_load(&snap) || !snap.running ||
+        strncmp(snap.boot_id, boot_id, sizeof(snap.boot_id)) != 0)
+        return false;
+
+    snap.program[sizeof(snap.program) - 1] = '\0';
+    bool ok = snap.program[0]
+            ? program_compile_file(snap.program, NULL, 0)
+            : program_compile_tabata(snap.work_sec, snap.rest_sec, snap.rounds);
+    if (!ok || program_phases() != snap.phases ||
+        program_total_sec() != snap.total_sec)
+        return false;
+
+    int64_t now = boottime_ns();
+    int64_t elapsed = now > snap.start_ns
+                    ? (now - snap.start_ns) / 1000000000 : 0;
+    if (elapsed >= program_total_sec() ||
+        !program_locate((uint32_t)elapsed, &timer.phase)) {
+        timer.state = IDLE;              /* finished while we were gone */
+        save_timer();
+        return false;
+    }
+
+    timer.work_sec      = snap.work_sec;
+    timer.rest_sec      = snap.rest_sec;
+    timer.rounds        = snap.rounds;
+    timer.start_ns      = snap.start_ns;
+    timer.elapsed       = (uint32_t)elapsed;
+    timer.sec_remaining = (int)(timer.phase.end - timer.elapsed);
+    timer.state         = RUNNING;
+    return true;
+}
+
+/* ----------------------------------------------------------------------
+   Workout history: a session that ends – run to the end, stopped or
+   quit – is one record appended to the history file (history.h).
+   "history" answers from a single pass over that file.
+   ---------------------------------------------------------------------- */
+static void record_session(bool completed)
+{
+    const uint32_t total = program_total_sec();
+    const uint32_t ran = timer.elapsed < total ? timer.elapsed : total;
+    uint32_t rounds;
+    HistorySession s = {
+        .start       = (int64_t)time(NULL) -
+                       (boottime_ns() - timer.start_ns) / 1000000000,
+        .total_sec   = ran,
+        .work_sec    = program_work_sec(ran, &rounds),
+        .planned_sec = total,
+        .completed   = completed,
+    };
+    s.rounds = rounds;
+    history_append(&s);
+}
+
+static const char *hms(char *buf, size_t len, uint64_t sec)
+{
+    snprintf(buf, len, "%llu:%02u:%02u", (unsigned long long)(sec / 3600),
+             (unsigned)(sec / 60 % 60), (unsigned)(sec % 60));
+    return buf;
+}
+
+static void history_reply(char *reply, size_t size)
+{
+    HistorySummary h;
+    if (!history_summarize(history_day(time(NULL)), &h)) {
+        snprintf(reply, size, "ERR No history file\n");
+        return;
+    }
+
+    char t1[24], t2[24];
+    size_t len = snprintf(reply, size,
+                          "sessions %lu completed %lu rounds %llu\n"
+                          "time %s work %s\n"
+                          "streak %u days longest %u\n",
+                          h.records, h.completed,
+                          (unsigned long long)h.rounds,
+                          hms(t1, sizeof(t1), h.total_sec),
+                          hms(t2, sizeof(t2), h.work_sec),
+                          h.streak_days, h.longest_streak_days);
+    for (int w = 0; w < HISTORY_WEEKS && len < size; ++w) {
+        time_t monday = (time_t)(h.week0_day + 7 * w) * 86400;
+        struct tm tm;
+        gmtime_r(&monday, &tm);
+        strftime(t1, sizeof(t1), "%Y-%m-%d", &tm);
+        len += snprintf(reply + len, size - len,
+                        "week %s sessions %u work %s\n", t1,
+                        h.week_sessions[w],
+                        hms(t2, sizeof(t2), h.week_work_sec[w]));
+    }
+    if (len < size)
+        snprintf(reply + len, size - len, "scanned %lu records in %lu us\n",
+                 h.records, h.scan_us);
+}
+
+/* ----------------------------------------------------------------------
+   Status page: the timer state as seen by "status", published to shared
+   memory (status_page.h) on every change so readers never have to ask.
+   ---------------------------------------------------------------------- */
+static void publish_status(void)
+{
+    static uint64_t updates;
+    StatusData d = {
+        .pid     = getpid(),
+        .running = timer.state == RUNNING,
+        .updates = ++updates,
+    };
+    if (timer.state == RUNNING) {
+        d.work          = timer.phase.work;
+        d.round         = timer.phase.round + 1;
+        d.rounds        = program_rounds();
+        d.phase         = timer.phase.index;
+        d.phases        = program_phases();
+        d.sec_remaining = (uint64_t)timer.sec_remaining;
+        d.phase_end_ns  = timer.start_ns +
+                          (int64_t)timer.phase.end * 1000000000;
+    }
+    status_page_publish(&d);
+}
+
 /* ----------------------------------------------------------------------
    Helper: clean up the socket file on exit
    ---------------------------------------------------------------------- */
 static void cleanup_socket(void)
 {
-    unlink(SOCK_PATH);
+    unlink(sock_path);
 }
 
 
@@ -81,9 +332,22 @@ static void cleanup_socket(void)
 static void sig_cleanup(int sig)
 {
     (void)sig;               /* unused */
-    unlink(SOCK_PATH);       /* remove the socket file */
+    unlink(sock_path);       /* remove the socket file */
     _exit(EXIT_FAILURE);    /* async‑safe exit */
 }
+
+/* ----------------------------------------------------------------------
+   Helper: SIGHUP asks for the asset pack to be reloaded.  The swap
+   itself happens in the main loop, between announcements.
+   ---------------------------------------------------------------------- */
+static volatile sig_atomic_t reload_requested = 0;
+
+static void sig_reload(int sig)
+{
+    (void)sig;
+    reload_requested = 1;
+}
+
 /* Register the handler for the signals we care about */
 static void setup_signal_handlers(void)
 {
@@ -96,12 +360,25 @@ static void setup_signal_handlers(void)
 
     /* Install the handler */
     if (sigaction(SIGINT,  &sa, NULL) == -1 ||
-        sigaction(SIGTERM, &sa, NULL) == -1 ||
-        sigaction(SIGHUP,  &sa, NULL) == -1) {
+        sigaction(SIGTERM, &sa, NULL) == -1) {
+        perror("sigaction");
+        exit(EXIT_FAILURE);
+    }
+
+    sa.sa_handler = sig_reload;
+    if (sigaction(SIGHUP, &sa, NULL) == -1) {
+        perror("sigaction");
+        exit(EXIT_FAILURE);
+    }
+
+    /* A client that hangs up before its reply must not kill the daemon */
+    sa.sa_handler = SIG_IGN;
+    if (sigaction(SIGPIPE, &sa, NULL) == -1) {
         perror("sigaction");
         exit(EXIT_FAILURE);
     }
 }
+
 /* ----------------------------------------------------------------------
    Daemon core: timer loop + command handling
    ---------------------------------------------------------------------- */
@@ -123,6 +400,19 @@ static int make_timerfd(void)
     return tfd;
 }
 
+/* CLOCK_MONOTONIC time of the expiry just read from ‘tfd’ */
+static int64_t timerfd_due_ns(int tfd)
+{
+    struct itimerspec its;
+    struct timespec now;
+    timerfd_gettime(tfd, &its);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec +
+           (int64_t)its.it_value.tv_sec * 1000000000 + its.it_value.tv_nsec -
+           (int64_t)its.it_interval.tv_sec * 1000000000 -
+           its.it_interval.tv_nsec;
+}
+
 /* Randomly maybe play a message */
 static void maybe_add_message(void)
 {
@@ -130,56 +420,253 @@ static void maybe_add_message(void)
     if(rand() % 20 == 0){
         int msg_num = (rand() % 100) + 1;
         snprintf(buf, sizeof(buf), "message%03d", msg_num);
-        audio_chain_add_by_name(buf);
+        audio_chain_add_by_name_prio(buf, AUDIO_PRIO_LOW);
     }
 }
 
-static void announce_done(void)
+/* ----------------------------------------------------------------------
+   Playing a queued announcement, with time‑to‑first‑sample kept per
+   announcement type for "stats".
+   ---------------------------------------------------------------------- */
+typedef enum {
+    ANN_ROUND, ANN_TIME_LEFT, ANN_DONE, ANN_PAUSED, ANN_RESUMED, ANN_TYPES
+} ann_type_t;
+
+static const char *const ann_names[ANN_TYPES] = {
+    "round", "timeleft", "done", "paused", "resumed"
+};
+
+static struct {
+    unsigned long count;
+    unsigned long sum_us;
+    unsigned long max_us;
+} ttfs_stats[ANN_TYPES];
+
+static void play_chain(ann_type_t type)
 {
-    audio_chain_add_by_name("done");
+    trace_begin(TR_ANNOUNCE, 0, ann_names[type]);
     audio_chain_play();
+    trace_end(TR_ANNOUNCE);
+    unsigned long us = audio_chain_last_ttfs_us();
+    if (us) {
+        ttfs_stats[type].count++;
+        ttfs_stats[type].sum_us += us;
+        if (us > ttfs_stats[type].max_us)
+            ttfs_stats[type].max_us = us;
+    }
     audio_chain_reset();
 }
 
-/* Randomly maybe play a message */
-static void announce_start_of_round()
+/* ----------------------------------------------------------------------
+   Numbers: "num0"–"num60" are assets of their own; a larger number is
+   said in parts – "num2 hundred num70 num5" – through the phrase cache,
+   so it costs one segment like the rest once it has been said.  Assets
+   made before num70, num80, num90, hundred and thousand existed read
+   it digit by digit instead, and so does anything from a million up.
+   ---------------------------------------------------------------------- */
+#define NUMBER_PARTS 12
+
+static char number_parts[NUMBER_PARTS][12];
+
+static unsigned push_part(unsigned k, const char *name)
+{
+    snprintf(number_parts[k], sizeof(number_parts[k]), "%s", name);
+    return k + 1;
+}
+
+static unsigned push_num(unsigned k, unsigned v)
+{
+    snprintf(number_parts[k], sizeof(number_parts[k]), "num%u", v);
+    return k + 1;
+}
+
+/* 1–999 as parts, from part ‘k’ on */
+static unsigned parts_below_1000(unsigned n, unsigned k)
+{
+    if (n >= 100) {
+        k = push_num(k, n / 100);
+        k = push_part(k, "hundred");
+        n %= 100;
+    }
+    if (n > 60) {
+        k = push_num(k, n / 10 * 10);
+        n %= 10;
+    }
+    if (n)
+        k = push_num(k, n);
+    return k;
+}
+
+static void add_number(unsigned n)
+{
+    const char *parts[NUMBER_PARTS];
+    unsigned k = 0;
+
+    if (n <= 60) {
+        k = push_num(k, n);
+    } else if (n < 1000000) {
+        if (n >= 1000) {
+            k = parts_below_1000(n / 1000, k);
+            k = push_part(k, "thousand");
+        }
+        k = parts_below_1000(n % 1000, k);
+    }
+    for (unsigned i = 0; i < k; ++i) {
+        parts[i] = number_parts[i];
+        if (!asset_get(parts[i]).data)
+            k = 0;                    // a part is missing: digits
+    }
+    if (k == 0) {
+        char digits[12];
+        snprintf(digits, sizeof(digits), "%u", n);
+        for (k = 0; digits[k]; ++k) {
+            push_num(k, (unsigned)(digits[k] - '0'));
+            parts[k] = number_parts[k];
+        }
+    }
+    audio_chain_add_phrase(parts, k);
+}
+
+static void announce_done(void)
+{
+    audio_chain_add_by_name("done");
+    play_chain(ANN_DONE);
+}
+
+/* Queue "round X of N, work/rest for M minutes" for the given phase */
+static void queue_round(int round, bool in_work, int phase_sec)
 {
-    char buf[16];
     audio_chain_add_by_name("round");
-    //Randomly generate message001 through message100
-    snprintf(buf, sizeof(buf), "num%d", timer.cur_round + 1);
-    audio_chain_add_by_name(buf);
+    add_number((unsigned)round + 1);
     audio_chain_add_by_name("of");
-    snprintf(buf, sizeof(buf), "num%d", timer.rounds);
-    audio_chain_add_by_name(buf);
+    add_number(program_rounds());
 
 
-    if(timer.in_work){
+    if(in_work){
         audio_chain_add_by_name("workfor");
     } else {
         audio_chain_add_by_name("restfor");
     }
-    //Convert n_min_remaining to const char*
-    snprintf(buf, sizeof(buf), "num%d", timer.sec_remaining / 60);
-    audio_chain_add_by_name(buf);
+    //Convert the phase length to whole minutes
+    add_number((unsigned)phase_sec / 60);
     audio_chain_add_by_name("minutes");
     maybe_add_message();
-    audio_chain_play();
-    audio_chain_reset();
+}
+
+static void announce_start_of_round()
+{
+    queue_round(timer.phase.round, timer.phase.work,
+                timer.phase.end - timer.phase.start);
+    play_chain(ANN_ROUND);
+
+}
+
+/* ----------------------------------------------------------------------
+   Lookahead: what is said at the end of the current phase is fully
+   known in advance, so it is decoded into the chain's staging buffer a
+   few seconds early.  Page faults on the asset data and the decode
+   itself then happen while the phase runs, not at the boundary.
+   ---------------------------------------------------------------------- */
+#define LOOKAHEAD_SEC 5
+
+typedef struct {
+    bool valid;
+    bool done;         // "done" rather than a round announcement
+    int  round;        // 0‑based round being announced
+    bool in_work;      // phase being announced
+    int  sec;          // its length
+} boundary_t;
 
+static boundary_t lookahead = { .valid = false };
+
+static struct {
+    unsigned long staged;          // announcements prepared ahead
+    unsigned long hits;            // boundaries served from staging
+    unsigned long misses;          // boundaries assembled on the spot
+    long faults_avoided;           // faults taken while staging
+    long faults_boundary;          // faults taken at boundaries
+} lookahead_stats;
+
+static long page_faults(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt + ru.ru_majflt;
+}
+
+/* The announcement for a phase; NULL means the program is over */
+static boundary_t boundary_for(const ProgramPos *p)
+{
+    if (!p)
+        return (boundary_t){ .valid = true, .done = true };
+    return (boundary_t){ .valid = true, .round = (int)p->round,
+                         .in_work = p->work,
+                         .sec = (int)(p->end - p->start) };
+}
+
+/* The announcement due when the current phase ends */
+static boundary_t next_boundary(void)
+{
+    ProgramPos next;
+    if (!program_phase(timer.phase.index + 1, &next))
+        return boundary_for(NULL);
+    return boundary_for(&next);
+}
+
+static void queue_boundary(const boundary_t *b)
+{
+    if (b->done)
+        audio_chain_add_by_name("done");
+    else
+        queue_round(b->round, b->in_work, b->sec);
+}
+
+static void stage_lookahead(void)
+{
+    long before = page_faults();
+
+    trace_begin(TR_STAGE, timer.phase.index + 1, NULL);
+    lookahead = next_boundary();
+    audio_chain_stage_begin();
+    queue_boundary(&lookahead);
+    audio_chain_stage_end();
+    trace_end(TR_STAGE);
+
+    lookahead_stats.staged++;
+    lookahead_stats.faults_avoided += page_faults() - before;
+}
+
+/* Announce the phase that just began (or "done"), preferring the
+   staged buffer when the lookahead predicted this boundary. */
+static void announce_boundary(const boundary_t *b)
+{
+    long before = page_faults();
+
+    if (lookahead.valid &&
+        lookahead.done == b->done &&
+        lookahead.round == b->round &&
+        lookahead.in_work == b->in_work &&
+        lookahead.sec == b->sec &&
+        audio_chain_use_staged()) {
+        lookahead_stats.hits++;
+    } else {
+        queue_boundary(b);
+        lookahead_stats.misses++;
+    }
+    lookahead.valid = false;
+    lookahead_stats.faults_boundary += page_faults() - before;
+
+    play_chain(b->done ? ANN_DONE : ANN_ROUND);
 }
 
 static void announce_time_left()
 {
-    char buf[16];
     int n = timer.sec_remaining / 60;
     audio_chain_add_by_name("youhave");
-    //Convert n_min_remaining to const char*
-    snprintf(buf, sizeof(buf), "num%d", n);
-    audio_chain_add_by_name(buf);
+    add_number((unsigned)n);
     audio_chain_add_by_name("minutesleft");
 
-    if(timer.in_work){
+    if(timer.phase.work){
         audio_chain_add_by_name("towork");
     }
     else {
@@ -187,105 +674,324 @@ static void announce_time_left()
     }
 
     maybe_add_message();
-    audio_chain_play();
-    audio_chain_reset();
+    play_chain(ANN_TIME_LEFT);
+}
+
+/* ----------------------------------------------------------------------
+   Final‑seconds countdown (CABATA_COUNTDOWN=n): the numbers are
+   preloaded cues played without a drain, so each one starts on its
+   second and the loop is back in select() while it sounds.  How far
+   after the timerfd expiry each cue started is kept for "stats".
+   ---------------------------------------------------------------------- */
+static int countdown_sec = 0;     // 0 = off
+static int64_t tick_due_ns = 0;   // CLOCK_MONOTONIC expiry of this tick
+
+static struct {
+    unsigned long count;
+    unsigned long late;           // still sounding at the next second
+    unsigned long sum_us, min_us, max_us;
+} countdown_stats;
+
+static bool load_countdown(void)
+{
+    static char names[AUDIO_CUE_SLOTS][8];
+    const char *ptrs[AUDIO_CUE_SLOTS];
+    for (int i = 0; i < countdown_sec; ++i) {
+        snprintf(names[i], sizeof(names[i]), "num%d", i + 1);
+        ptrs[i] = names[i];
+    }
+    return audio_cues_load(ptrs, (unsigned)countdown_sec);
+}
+
+static void announce_countdown(int n)
+{
+    AudioCueTiming t;
+    if (!audio_cue_play((unsigned)n - 1, &t) || !t.onset_ns)
+        return;
+
+    unsigned long us = t.onset_ns > tick_due_ns
+                     ? (unsigned long)(t.onset_ns - tick_due_ns) / 1000 : 0;
+    if (!countdown_stats.count || us < countdown_stats.min_us)
+        countdown_stats.min_us = us;
+    if (us > countdown_stats.max_us)
+        countdown_stats.max_us = us;
+    countdown_stats.sum_us += us;
+    countdown_stats.count++;
+    if (t.end_ns > tick_due_ns + 1000000000)
+        countdown_stats.late++;
 }
 
 static void announce_paused(){
     audio_chain_add_by_name("paused");
-    audio_chain_play();
-    audio_chain_reset();
+    play_chain(ANN_PAUSED);
+}
+
+static void announce_resumed(void)
+{
+    audio_chain_add_by_name("resumed");
+    play_chain(ANN_RESUMED);
 }
 
-/* Called every second – advances the timer, plays sounds, etc. */
-static void tick(void)
+/* Called from the timerfd with the number of seconds that passed –
+   advances the timer, plays sounds, etc.  Crossing a phase end is one
+   binary search however many phases were skipped, and only the phase
+   the session lands in is announced. */
+static void tick(uint64_t secs)
 {
+    trace_instant(TR_TICK, (int64_t)secs, NULL);
     if (timer.state != RUNNING)
         return;
 
-    timer.sec_remaining--;
-    if (timer.sec_remaining <= 0) {
-        if (timer.in_work) {
-            /* work finished → start rest */
-            timer.in_work = false;
-            timer.sec_remaining = timer.rest_sec;
-            announce_start_of_round();
-        } else {
-            /* rest finished → next round or stop */
-            timer.cur_round++;
-            if (timer.cur_round >= timer.rounds) {
-                /* all rounds finished */
-                timer.state = IDLE;
-                fprintf(stderr, "Tabata complete.\n");
-                announce_done();
-                return;
-            }
-
-            timer.in_work = true;
-            timer.sec_remaining = timer.work_sec;
+    timer.elapsed = secs < UINT32_MAX - timer.elapsed
+                  ? timer.elapsed + (uint32_t)secs : UINT32_MAX;
 
-            announce_start_of_round();
+    if (timer.elapsed >= timer.phase.end) {
+        if (!program_locate(timer.elapsed, &timer.phase)) {
+            /* all phases finished */
+            boundary_t b = boundary_for(NULL);
+            record_session(true);
+            timer.state = IDLE;
+            timer.sec_remaining = 0;
+            save_timer();
+            publish_status();
+            trace_instant(TR_PHASE, -1, "done");
+            fprintf(stderr, "Tabata complete.\n");
+            announce_boundary(&b);
+            return;
         }
+        boundary_t b = boundary_for(&timer.phase);
+        timer.sec_remaining = (int)(timer.phase.end - timer.elapsed);
+        publish_status();
+        trace_instant(TR_PHASE, timer.phase.index,
+                      timer.phase.work ? "work" : "rest");
+        announce_boundary(&b);
     } else {
+        timer.sec_remaining = (int)(timer.phase.end - timer.elapsed);
+        publish_status();
+        //Final seconds – only on time, never for a second long gone
+        if (secs == 1 && timer.sec_remaining <= countdown_sec) {
+            announce_countdown(timer.sec_remaining);
+        }
         //Check if timer.sec_remaining is divisible by 5 minutes:
         if (timer.sec_remaining % 300 == 0) {
             announce_time_left();
         }
+        //Prepare the boundary announcement while the phase still runs
+        if (!lookahead.valid && timer.sec_remaining <= LOOKAHEAD_SEC) {
+            stage_lookahead();
+        }
     }
 }
 
 /* ----------------------------------------------------------------------
    Command processing (client → daemon)
    ---------------------------------------------------------------------- */
+
+/* Start the freshly compiled program from its first phase */
+static void begin_session(void)
+{
+    program_phase(0, &timer.phase);
+    timer.elapsed = 0;
+    timer.sec_remaining = (int)timer.phase.end;
+    timer.start_ns = boottime_ns();
+    timer.state = RUNNING;
+    lookahead.valid = false;
+    save_timer();
+    publish_status();
+    trace_instant(TR_PHASE, 0, timer.phase.work ? "work" : "rest");
+}
+
+/* ----------------------------------------------------------------------
+   Startup timing: when "--daemon" reached each step, counted from the
+   top of main(), for "stats".  The device is opened in the background
+   (audio_init_async), so "audio" is only the setup around it.
+   ---------------------------------------------------------------------- */
+typedef enum {
+    ST_DAEMON, ST_LISTEN, ST_AUDIO, ST_RECOVER, ST_SERVING, ST_REPLY,
+    ST_STEPS
+} startup_step_t;
+
+static const char *const startup_names[ST_STEPS] = {
+    "daemon", "listen", "audio", "recover", "serving", "reply"
+};
+
+static struct timespec t_main;
+static unsigned long startup_us[ST_STEPS];
+static bool startup_done[ST_STEPS];
+
+static void startup_mark(startup_step_t step)
+{
+    if (startup_done[step])
+        return;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    startup_us[step] = (now.tv_sec - t_main.tv_sec) * 1000000L +
+                       (now.tv_nsec - t_main.tv_nsec) / 1000;
+    startup_done[step] = true;
+}
+
 static void handle_command(const char *cmd, int client_fd)
 {
-    char reply[128] = {0};
+    char reply[1024] = {0};
+    /* The reply goes out first; any announcement plays after it, so the
+       client never waits for the sound card */
+    void (*announce)(void) = NULL;
 
+    trace_begin(TR_COMMAND, 0, cmd);
     if (strncmp(cmd, "start", 5) == 0) {
         int w, r, n;
         if (sscanf(cmd + 5, "%d %d %d", &w, &r, &n) != 3) {
             snprintf(reply, sizeof(reply), "ERR Invalid start parameters\n");
         } else if (timer.state == RUNNING) {
             snprintf(reply, sizeof(reply), "ERR Timer already running\n");
+        } else if (!program_compile_tabata(w, r, n)) {
+            snprintf(reply, sizeof(reply), "ERR Invalid start parameters\n");
         } else {
             timer.work_sec = w;
             timer.rest_sec = r;
             timer.rounds   = n;
-            timer.cur_round = 0;
-            timer.in_work = true;
-            timer.sec_remaining = w;
-            timer.state = RUNNING;
+            begin_session();
 
             //These variables are only used here
             snprintf(reply, sizeof(reply), "OK Started\n");
 
-            announce_start_of_round();
+            announce = announce_start_of_round;
+        }
+    } else if (strncmp(cmd, "program ", 8) == 0) {
+        char err[200];
+        if (timer.state == RUNNING) {
+            snprintf(reply, sizeof(reply), "ERR Timer already running\n");
+        } else if (cmd[8] != '/') {
+            snprintf(reply, sizeof(reply), "ERR Program path must be absolute\n");
+        } else if (!program_compile_file(cmd + 8, err, sizeof(err))) {
+            snprintf(reply, sizeof(reply), "ERR %s\n", err);
+        } else {
+            timer.work_sec = timer.rest_sec = timer.rounds = 0;
+            begin_session();
+            snprintf(reply, sizeof(reply),
+                     "OK Started %u intervals, %u rounds, %u:%02u\n",
+                     program_phases(), program_rounds(),
+                     program_total_sec() / 60, program_total_sec() % 60);
+
+            announce = announce_start_of_round;
         }
     } else if (strcmp(cmd, "stop") == 0) {
         if (timer.state == IDLE) {
             snprintf(reply, sizeof(reply), "ERR Not running\n");
         } else {
+            record_session(false);
             timer.state = IDLE;
+            lookahead.valid = false;
+            save_timer();
+            publish_status();
             snprintf(reply, sizeof(reply), "OK Stopped\n");
-            announce_paused();
+            announce = announce_paused;
         }
     } else if (strcmp(cmd, "status") == 0) {
         if (timer.state == IDLE) {
             snprintf(reply, sizeof(reply), "IDLE\n");
-            announce_paused();
+            announce = announce_paused;
         } else {
-            const char *phase = timer.in_work ? "WORK" : "REST";
+            const char *phase = timer.phase.work ? "WORK" : "REST";
             snprintf(reply, sizeof(reply),
-                     "RUNNING round %d/%d %s %d sec left\n",
-                     timer.cur_round + 1, timer.rounds, phase,
+                     "RUNNING round %u/%u %s %d sec left\n",
+                     timer.phase.round + 1, program_rounds(), phase,
                      timer.sec_remaining);
 
-            announce_time_left();
+            announce = announce_time_left;
+        }
+    } else if (strcmp(cmd, "next") == 0) {
+        ProgramPos next;
+        if (timer.state == IDLE) {
+            snprintf(reply, sizeof(reply), "IDLE\n");
+        } else if (!program_phase(timer.phase.index + 1, &next)) {
+            snprintf(reply, sizeof(reply), "NEXT DONE in %d sec\n",
+                     timer.sec_remaining);
+        } else {
+            snprintf(reply, sizeof(reply),
+                     "NEXT round %u/%u %s for %u sec in %d sec\n",
+                     next.round + 1, program_rounds(),
+                     next.work ? "WORK" : "REST", next.end - next.start,
+                     timer.sec_remaining);
         }
+    } else if (strcmp(cmd, "stats") == 0) {
+        AudioStats as;
+        audio_get_stats(&as);
+        size_t len = snprintf(reply, sizeof(reply),
+                 "lookahead staged %lu hits %lu misses %lu\n"
+                 "faults avoided %ld at boundaries %ld\n"
+                 "rt %s mlock %s underruns %lu\n"
+                 "alsa period %lu buffer %lu frames, grown %lu shrunk %lu\n",
+                 lookahead_stats.staged, lookahead_stats.hits,
+                 lookahead_stats.misses, lookahead_stats.faults_avoided,
+                 lookahead_stats.faults_boundary,
+                 as.rt_sched ? "fifo" : "off",
+                 as.mem_locked_all ? "all" : as.mem_locked ? "buffers" : "off",
+                 as.underruns, as.period_frames, as.buffer_frames,
+                 as.period_grows, as.period_shrinks);
+        for (int st = 0; st < ST_STEPS && len < sizeof(reply); ++st)
+            len += snprintf(reply + len, sizeof(reply) - len, "%s%s %lu%s",
+                            st ? " " : "startup ", startup_names[st],
+                            startup_us[st],
+                            st == ST_STEPS - 1 ? " us\n" : "");
+        if (len < sizeof(reply))
+            len += snprintf(reply + len, sizeof(reply) - len,
+                            "alsa open %lu us in background, play waited"
+                            " %lu us\n", as.open_us, as.open_wait_us);
+        if (len < sizeof(reply))
+            len += snprintf(reply + len, sizeof(reply) - len,
+                            "phrases cached %lu composed %lu\n",
+                            as.phrase_hits, as.phrase_misses);
+        if (countdown_sec && len < sizeof(reply)) {
+            const unsigned long n = countdown_stats.count;
+            len += snprintf(reply + len, sizeof(reply) - len,
+                            "countdown n %lu onset avg %lu min %lu max %lu us"
+                            " late %lu\n",
+                            n, n ? countdown_stats.sum_us / n : 0,
+                            countdown_stats.min_us, countdown_stats.max_us,
+                            countdown_stats.late);
+        }
+        AudioDeviceStats dev[AUDIO_MAX_DEVICES];
+        unsigned ndev = audio_get_device_stats(dev, AUDIO_MAX_DEVICES);
+        for (unsigned i = 0; i < ndev && len < sizeof(reply); ++i) {
+            len += snprintf(reply + len, sizeof(reply) - len,
+                            "device %s underruns %lu skipped %lu drift %+ld"
+                            " period %lu\n",
+                            dev[i].name, dev[i].underruns, dev[i].skipped,
+                            dev[i].drift_frames, dev[i].period_frames);
+        }
+        for (int t = 0; t < ANN_TYPES && len < sizeof(reply); ++t) {
+            const unsigned long n = ttfs_stats[t].count;
+            len += snprintf(reply + len, sizeof(reply) - len,
+                            "ttfs %-8s n %lu avg %lu us max %lu us\n",
+                            ann_names[t], n,
+                            n ? ttfs_stats[t].sum_us / n : 0,
+                            ttfs_stats[t].max_us);
+        }
+    } else if (strcmp(cmd, "history") == 0) {
+        history_reply(reply, sizeof(reply));
+    } else if (strcmp(cmd, "trace dump") == 0) {
+        /* Far more than a reply buffer, and the reader may be slow: a
+           snapshot is streamed out by a thread while the timer runs on.
+           The connection closes once both it and we are done with it. */
+        int fd = dup(client_fd);
+        if (fd != -1 && trace_dump_async(fd)) {
+            trace_end(TR_COMMAND);
+            return;
+        }
+        if (fd != -1)
+            close(fd);
+        snprintf(reply, sizeof(reply), "ERR Trace dump busy\n");
     } else if (strcmp(cmd, "quit") == 0) {
         snprintf(reply, sizeof(reply), "OK Bye\n");
         write(client_fd, reply, strlen(reply));
 
+        /* A deliberate quit ends the session – nothing to resume */
+        if (timer.state == RUNNING)
+            record_session(false);
+        timer.state = IDLE;
+        save_timer();
+
         announce_done();
         /* Tell main loop to exit */
         exit(EXIT_SUCCESS);
@@ -293,7 +999,13 @@ static void handle_command(const char *cmd, int client_fd)
         snprintf(reply, sizeof(reply), "ERR Unknown command\n");
     }
 
+    trace_end(TR_COMMAND);
     write(client_fd, reply, strlen(reply));
+    startup_mark(ST_REPLY);
+    if (announce) {
+        shutdown(client_fd, SHUT_WR);   /* reply complete – client exits */
+        announce();
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -312,8 +1024,8 @@ static void daemon_loop(void)
 
     memset(&addr, 0, sizeof(addr));
     addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCK_PATH, sizeof(addr.sun_path) - 1);
-    unlink(SOCK_PATH);               // remove stale socket, if any
+    strncpy(addr.sun_path, sock_path, sizeof(addr.sun_path) - 1);
+    unlink(sock_path);               // remove stale socket, if any
     if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
         perror("bind");
         exit(EXIT_FAILURE);
@@ -322,19 +1034,63 @@ static void daemon_loop(void)
         perror("listen");
         exit(EXIT_FAILURE);
     }
+    startup_mark(ST_LISTEN);
 
     atexit(cleanup_socket);          // ensure socket file is removed
 
-    //Audio setup
-    if (!audio_init()) exit(EXIT_FAILURE);
+    //Status page for readers that do not want to talk to us
+    if (status_page_create(shm_name))
+        atexit(status_page_destroy);
+
+    //Audio setup: the buffers first, so the real‑time mode can lock
+    //them, then scheduling, so the device threads inherit it
+    const char *sink = getenv("CABATA_AUDIO");
+    audio_set_null_sink(sink && strcmp(sink, "null") == 0);
     atexit(audio_cleanup);
     if (!audio_chain_init()) exit(EXIT_FAILURE);
     atexit(audio_chain_cleanup);
+    atexit(program_free);
+
+    const unsigned prio = env_uint("CABATA_RT", 0, 0, 99);
+    if (prio)
+        audio_rt_enable((int)prio);
+
+    //The device opens in the background; the first play waits for it
+    //and reports a device that failed
+    audio_init_async();
+
+    audio_chain_set_streaming(env_uint("CABATA_STREAM", 0, 0, 1) != 0);
+
+    audio_set_dsp(env_uint("CABATA_GAIN", 100, 0, 199),
+                  env_uint("CABATA_DUCK", 50, 0, 100),
+                  env_uint("CABATA_FADE_MS", 5, 0, 1000));
+
+    countdown_sec = (int)env_uint("CABATA_COUNTDOWN", 0,
+                                  0, AUDIO_CUE_SLOTS);
+    if (countdown_sec && !load_countdown()) {
+        fprintf(stderr, "countdown cues unavailable, countdown off\n");
+        countdown_sec = 0;
+    }
 
     timer_fd = make_timerfd();
+    startup_mark(ST_AUDIO);
 
     fd_set readset;
 
+    //Resume a session a crashed daemon left behind – announced at the
+    //first tick or command, once the client that started us (which
+    //connects a moment after we listen) has its reply
+    bool resume_pending = false;
+    read_boot_id();
+    if (persist_open(state_path, sizeof(timer_snapshot_t))) {
+        atexit(persist_close);
+        resume_pending = recover_timer();
+    }
+    if (history_open(history_path))
+        atexit(history_close);
+    publish_status();
+    startup_mark(ST_RECOVER);
+
     //Randomize seed for random messages
     srand(time(NULL));
     for (;;) {
@@ -343,7 +1099,21 @@ static void daemon_loop(void)
         FD_SET(timer_fd, &readset);
         int maxfd = (listen_fd > timer_fd) ? listen_fd : timer_fd;
 
+        startup_mark(ST_SERVING);
         int rc = select(maxfd + 1, &readset, NULL, NULL, NULL);
+
+        /* ----- SIGHUP: swap in the new asset pack, keep the session ----- */
+        if (reload_requested) {
+            reload_requested = 0;
+            if (!asset_pack_reload()) {
+                fprintf(stderr, "asset pack reload failed, keeping old one\n");
+            } else {
+                audio_phrases_flush();
+                if (countdown_sec && !load_countdown())
+                    countdown_sec = 0;
+            }
+        }
+
         if (rc == -1) {
             if (errno == EINTR) continue;
             perror("select");
@@ -354,9 +1124,9 @@ static void daemon_loop(void)
         if (FD_ISSET(timer_fd, &readset)) {
             uint64_t expirations;
             if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
-                /* If we missed several seconds, process them one‑by‑one */
-                for (uint64_t i = 0; i < expirations; ++i)
-                    tick();
+                /* Missed seconds are caught up in one step */
+                tick_due_ns = timerfd_due_ns(timer_fd);
+                tick(expirations);
             }
         }
 
@@ -378,58 +1148,15 @@ static void daemon_loop(void)
             }
             close(client_fd);
         }
-    }
-
-    close(timer_fd);
-    close(listen_fd);
-}
-
-/* ----------------------------------------------------------------------
-   Client helper – send a command to the daemon and print the reply
-   ---------------------------------------------------------------------- */
-static void client_send(const char *cmd, const char *my_path)
-{
-    struct sockaddr_un addr;
-    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (fd == -1) {
-        perror("socket");
-        exit(EXIT_FAILURE);
-    }
 
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-    strncpy(addr.sun_path, SOCK_PATH, sizeof(addr.sun_path) - 1);
-
-    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
-        if (errno == ENOENT || errno == ECONNREFUSED) {
-            /* stale socket – delete it and try to spawn the daemon */
-            unlink(SOCK_PATH);
-            pid_t pid = fork();
-            if (pid == 0) {
-                execlp(my_path, my_path, "--daemon", (char *)NULL);
-                _exit(EXIT_FAILURE);
-            }
-            close(fd);
-            sleep(1);                 /* give daemon time to bind */
-            client_send(cmd, my_path);/* retry */
-            return;
+        if (resume_pending) {
+            resume_pending = false;
+            announce_resumed();
         }
-        perror("connect");
-        close(fd);
-        exit(EXIT_FAILURE);
     }
 
-    /* ----- send the command ----- */
-    write(fd, cmd, strlen(cmd));
-    write(fd, "\n", 1);
-
-    char reply[256];
-    ssize_t n = read(fd, reply, sizeof(reply) - 1);
-    if (n > 0) {
-        reply[n] = '\0';
-        fputs(reply, stdout);
-    }
-    close(fd);
+    close(timer_fd);
+    close(listen_fd);
 }
 
 /* ----------------------------------------------------------------------
@@ -439,51 +1166,46 @@ int main(int argc, char *argv[])
 {
     if (argc > 1 && strcmp(argv[1], "--daemon") == 0) {
         /* ---------- Daemon mode ---------- */
+        clock_gettime(CLOCK_MONOTONIC, &t_main);
+        const char *env;
+        if ((env = getenv("CABATA_SOCK"))  && *env) sock_path  = env;
+        if ((env = getenv("CABATA_SHM"))   && *env) shm_name   = env;
+        static char state_buf[PATH_MAX];
+        if ((env = getenv("CABATA_STATE")) && *env) {
+            state_path = env;
+        } else if ((env = getenv("XDG_RUNTIME_DIR")) && *env) {
+            snprintf(state_buf, sizeof(state_buf), "%s/" STATE_FILE, env);
+            state_path = state_buf;
+        } else if ((env = getenv("HOME")) && *env) {
+            snprintf(state_buf, sizeof(state_buf), "%s/" STATE_DOTFILE,
+                     env);
+            state_path = state_buf;
+        }
+        static char history_buf[PATH_MAX];
+        if ((env = getenv("CABATA_HISTORY")) && *env) {
+            history_path = env;
+        } else if ((env = getenv("HOME")) && *env) {
+            snprintf(history_buf, sizeof(history_buf), "%s/" HISTORY_FILE,
+                     env);
+            history_path = history_buf;
+        }
+
+        /* Map the optional external asset pack before daemon() moves us
+           to / – relative paths still resolve and errors are visible. */
+        const char *pack = getenv("CABATA_PACK");
+        if (pack && *pack && !asset_pack_open(pack))
+            fprintf(stderr, "Using embedded assets only\n");
+
         if (daemon(0, 0) == -1) {
             perror("daemon");
             exit(EXIT_FAILURE);
         }
+        startup_mark(ST_DAEMON);
         setup_signal_handlers();
         daemon_loop();          /* never returns */
         return 0;
     }
 
-    /* ---------- Client mode ---------- */
-    if (argc < 2) {
-        fprintf(stderr,
-                "Usage: %s <command> [args]\n"
-                "Commands:\n"
-                "  start <work_sec> <rest_sec> <rounds>\n"
-                "  stop\n"
-                "  status\n"
-                "  quit   (stop daemon)\n",
-                argv[0]);
-        return EXIT_FAILURE;
-    }
-
-    /* Build the command string that will be sent to the daemon */
-    char cmd_buf[MAX_CMD_LEN] = {0};
-
-    if (strcmp(argv[1], "start") == 0) {
-        if (argc != 5) {
-            fprintf(stderr, "start needs three numbers: work rest rounds\n");
-            return EXIT_FAILURE;
-        }
-        snprintf(cmd_buf, sizeof(cmd_buf), "start %s %s %s",
-                 argv[2], argv[3], argv[4]);
-    } else if (strcmp(argv[1], "stop") == 0) {
-        strcpy(cmd_buf, "stop");
-    } else if (strcmp(argv[1], "status") == 0) {
-        strcpy(cmd_buf, "status");
-    } else if (strcmp(argv[1], "quit") == 0) {
-        strcpy(cmd_buf, "quit");
-    } else {
-        fprintf(stderr, "Unknown command '%s'\n", argv[1]);
-        return EXIT_FAILURE;
-    }
-
-    /* Pass argv[0] (the executable path) to client_send() */
-    client_send(cmd_buf, argv[0]);
-
-    return EXIT_SUCCESS;
+    /* ---------- Client mode (client.c) ---------- */
+    return client_main(argc, argv, argv[0]);
 }
@@ -0,0 +1,144 @@
+/* alloc_check.c
+ *
+ * The announcement path must not touch the heap once it is warmed up.
+ *
+ * Usage:
+ *   alloc_check [rounds]
+ *
+ * Plays the daemon's kinds of announcement through the null sink – a
+ * round announcement (copied and streamed), a staged lookahead, the
+ * time‑left one with a ducked message, a composed number from the
+ * phrase cache, a countdown cue, a one‑shot clip – once to warm up,
+ * then ‘rounds’ more times (default 100) with every heap allocation in
+ * the process counted.  malloc() and friends are replaced for the
+ * whole binary, so allocations inside libc and alsa‑lib are caught as
+ * well.  Any allocation fails the check, and with it "make check".
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "audio.h"
+
+/* -----------------------------------------------------------------
+ *  Counting allocator (glibc: forward to the real one)
+ * ----------------------------------------------------------------- */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+extern void  __libc_free(void *p);
+
+static bool          counting = false;
+static unsigned long allocs   = 0;
+
+#define COUNT() do { if (counting) allocs++; } while (0)
+
+void *malloc(size_t size)              { COUNT(); return __libc_malloc(size); }
+void *calloc(size_t n, size_t size)    { COUNT(); return __libc_calloc(n, size); }
+void *realloc(void *p, size_t size)    { COUNT(); return __libc_realloc(p, size); }
+void  free(void *p)                    { __libc_free(p); }
+
+void *aligned_alloc(size_t align, size_t size)
+{
+    COUNT();
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **out, size_t align, size_t size)
+{
+    COUNT();
+    *out = __libc_memalign(align, size);
+    return *out ? 0 : ENOMEM;
+}
+
+/* -----------------------------------------------------------------
+ *  The announcements, as tabata.c builds them
+ * ----------------------------------------------------------------- */
+static bool add_all(const char *const *names, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        if (!audio_chain_add_by_name(names[i]))
+            return false;
+    return true;
+}
+
+static bool one_round(void)
+{
+    static const char *const round[] = {
+        "round", "num3", "of", "num8", "workfor", "num1", "minutes"
+    };
+    static const char *const left[] = {
+        "youhave", "num5", "minutesleft", "towork"
+    };
+    static const char *const done[] = { "done" };
+    static const char *const sixty_five[] = { "num60", "num5" };
+    bool ok = true;
+
+    /* round announcement, decoded up front and streamed */
+    for (int streaming = 0; streaming < 2; ++streaming) {
+        audio_chain_set_streaming(streaming);
+        ok &= add_all(round, 7) && audio_chain_play();
+        audio_chain_reset();
+    }
+    audio_chain_set_streaming(false);
+
+    /* lookahead: stage now, play later */
+    audio_chain_stage_begin();
+    ok &= add_all(round, 7);
+    audio_chain_stage_end();
+    ok &= audio_chain_use_staged() && audio_chain_play();
+    audio_chain_reset();
+
+    /* time left, with a ducked message */
+    ok &= add_all(left, 4) &&
+          audio_chain_add_by_name_prio("message042", AUDIO_PRIO_LOW) &&
+          audio_chain_play();
+    audio_chain_reset();
+
+    /* a number past num60, composed on warm‑up and cached after */
+    ok &= audio_chain_add_phrase(sixty_five, 2) && audio_chain_play();
+    audio_chain_reset();
+
+    ok &= add_all(done, 1) && audio_chain_play();
+    audio_chain_reset();
+
+    AudioCueTiming t;
+    ok &= audio_cue_play(2, &t);
+
+    ok &= play_embedded_wav_by_name("paused");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    long rounds = argc > 1 ? atol(argv[1]) : 100;
+
+    audio_set_null_sink(true);
+    static const char *const cues[] = { "num1", "num2", "num3" };
+    if (!audio_init() || !audio_chain_init() || !audio_cues_load(cues, 3)) {
+        fprintf(stderr, "alloc_check: audio setup failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!one_round()) {                       /* warm‑up */
+        fprintf(stderr, "alloc_check: announcement failed\n");
+        return EXIT_FAILURE;
+    }
+
+    counting = true;
+    bool ok = true;
+    for (long i = 0; i < rounds; ++i)
+        ok &= one_round();
+    counting = false;
+
+    audio_chain_cleanup();
+
+    if (!ok) {
+        fprintf(stderr, "alloc_check: announcement failed\n");
+        return EXIT_FAILURE;
+    }
+    printf("alloc_check: %ld rounds, %lu allocations\n", rounds, allocs);
+    return allocs ? EXIT_FAILURE : EXIT_SUCCESS;
+}
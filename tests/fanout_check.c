@@ -0,0 +1,141 @@
+/* fanout_check.c
+ *
+ * Fan‑out to several devices: plays keep pace with the fastest device
+ * and end when it has played the end‑of‑play slot out, a device that
+ * hangs skips ahead when it comes back, and shutting down does not
+ * wait for queued audio.
+ *
+ * Usage:
+ *   fanout_check
+ *
+ * Runs two devices through the null sink – no PCM is opened, but each
+ * device's writer thread takes as long over the stream as real
+ * playback would – and holds one of them with audio_fanout_hold().
+ * Takes a few seconds; any failed check fails "make check".
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "audio.h"
+#include "asset_pack.h"
+#include "wav.h"
+
+static const char *const announcement[] = { "round", "num3" };
+#define PARTS (sizeof announcement / sizeof *announcement)
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            fprintf(stderr, "fanout_check: " __VA_ARGS__);          \
+            fputc('\n', stderr);                                    \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void settle(void)                    /* let the threads catch up */
+{
+    nanosleep(&(struct timespec){ .tv_nsec = 200000000 }, NULL);
+}
+
+/* Length of the announcement as played, in ms */
+static double announcement_ms(void)
+{
+    size_t frames = 0;
+    unsigned int rate = 0;
+    for (size_t i = 0; i < PARTS; ++i) {
+        const EmbeddedWav e = asset_get(announcement[i]);
+        WavInfo w;
+        if (!e.data || !wav_parse(e.data, e.size, &w))
+            return 0;
+        frames += w.frames;
+        rate = w.rate;
+    }
+    return rate ? frames * 1000.0 / rate : 0;
+}
+
+/* Play the announcement; how long the call took, in ms */
+static double play(void)
+{
+    double t0 = now_ms();
+    bool ok = true;
+    for (size_t i = 0; i < PARTS; ++i)
+        ok &= audio_chain_add_by_name(announcement[i]);
+    ok &= audio_chain_play();
+    audio_chain_reset();
+    CHECK(ok, "announcement failed");
+    return now_ms() - t0;
+}
+
+int main(void)
+{
+    audio_set_null_sink(true);
+    setenv("CABATA_DEVICES", "left right", 1);
+    if (!audio_init() || !audio_chain_init()) {
+        fprintf(stderr, "fanout_check: audio setup failed\n");
+        return EXIT_FAILURE;
+    }
+    const double len = announcement_ms();
+    AudioDeviceStats d[2];
+    if (len < 1000 || audio_get_device_stats(d, 2) != 2) {
+        fprintf(stderr, "fanout_check: no fan‑out to two devices\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Both playing: the call lasts as long as the announcement */
+    double took = play();
+    settle();
+    audio_get_device_stats(d, 2);
+    CHECK(took > len - 50 && took < len + 500,
+          "play took %.0f ms for %.0f ms of audio", took, len);
+    CHECK(audio_chain_last_ttfs_us() < 50000,
+          "first slot taken after %lu us", audio_chain_last_ttfs_us());
+    CHECK(d[0].plays == 1 && d[1].plays == 1,
+          "end of play reached %lu / %lu times", d[0].plays, d[1].plays);
+    CHECK(d[0].skipped == 0 && d[1].skipped == 0, "skipped with no stall");
+
+    /* One hangs: the other sets the pace, the hung one misses the end */
+    audio_fanout_hold(1, true);
+    took = play();
+    audio_fanout_hold(1, false);
+    settle();
+    audio_get_device_stats(d, 2);
+    CHECK(took > len - 50 && took < len + 500,
+          "play with a hung device took %.0f ms", took);
+    CHECK(d[0].plays == 2 && d[1].plays == 1,
+          "end of play reached %lu / %lu times", d[0].plays, d[1].plays);
+    CHECK(d[1].skipped > 0 && d[0].skipped == 0,
+          "skipped %lu / %lu slots", d[0].skipped, d[1].skipped);
+
+    /* Back in step: both play the next one to its end */
+    const unsigned long skipped = d[1].skipped;
+    play();
+    settle();
+    audio_get_device_stats(d, 2);
+    CHECK(d[0].plays == 3 && d[1].plays == 2,
+          "end of play reached %lu / %lu times", d[0].plays, d[1].plays);
+    CHECK(d[1].skipped == skipped, "skipped again once back");
+
+    /* Neither moves: the play gives up waiting, shutdown drops the rest */
+    audio_fanout_hold(0, true);
+    audio_fanout_hold(1, true);
+    took = play();
+    CHECK(took < 1000, "play with no device moving took %.0f ms", took);
+    double t0 = now_ms();
+    audio_chain_cleanup();
+    took = now_ms() - t0;
+    CHECK(took < 250, "shutdown took %.0f ms", took);
+
+    if (failures)
+        return EXIT_FAILURE;
+    printf("fanout_check: ok\n");
+    return EXIT_SUCCESS;
+}
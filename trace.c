@@ -0,0 +1,234 @@
+/*=====================================================================
+ *  trace.c  –  lock‑free event ring and Chrome trace export (see
+ *              trace.h)
+ *====================================================================*/
+#define _GNU_SOURCE               /* syscall() */
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    uint64_t seq;                 /* index + 1 once written, else 0 */
+    uint64_t ts_ns;               /* CLOCK_MONOTONIC                */
+    int64_t  arg;
+    uint32_t tid;
+    uint16_t kind;
+    char     ph;
+    char     detail[TRACE_DETAIL_MAX];
+} TraceSlot;
+
+static TraceSlot g_ring[TRACE_CAPACITY];
+static uint64_t  g_head = 0;      /* next index to claim */
+
+static const struct {
+    const char *name;
+    const char *cat;
+} kinds[TR_KINDS] = {
+    [TR_TICK]       = { "tick",       "timer" },
+    [TR_PHASE]      = { "phase",      "timer" },
+    [TR_COMMAND]    = { "command",    "control" },
+    [TR_ANNOUNCE]   = { "announce",   "timer" },
+    [TR_STAGE]      = { "stage",      "timer" },
+    [TR_CHAIN_ADD]  = { "chain_add",  "audio" },
+    [TR_PCM_CONFIG] = { "pcm_config", "alsa" },
+    [TR_PCM_WRITE]  = { "pcm_write",  "alsa" },
+    [TR_XRUN]       = { "xrun",       "alsa" },
+    [TR_DRAIN]      = { "drain",      "alsa" },
+    [TR_CUE]        = { "cue",        "timer" },
+    [TR_SKIP]       = { "skip",       "alsa" },
+    [TR_OPEN]       = { "open",       "alsa" },
+};
+
+static uint32_t thread_id(void)
+{
+    static __thread uint32_t tid;
+    if (!tid)
+        tid = (uint32_t)syscall(SYS_gettid);
+    return tid;
+}
+
+/* Claim the next slot and publish it.  A dump that races with the
+   write sees seq == 0 (or a newer seq) and skips the slot. */
+static void emit(char ph, TraceKind kind, int64_t arg, const char *detail)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t i = __atomic_fetch_add(&g_head, 1, __ATOMIC_RELAXED);
+    TraceSlot *s = &g_ring[i & (TRACE_CAPACITY - 1)];
+
+    __atomic_store_n(&s->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->ts_ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    s->arg   = arg;
+    s->tid   = thread_id();
+    s->kind  = (uint16_t)kind;
+    s->ph    = ph;
+    if (detail) {
+        strncpy(s->detail, detail, sizeof s->detail - 1);
+        s->detail[sizeof s->detail - 1] = '\0';
+    } else {
+        s->detail[0] = '\0';
+    }
+    __atomic_store_n(&s->seq, i + 1, __ATOMIC_RELEASE);
+}
+
+void trace_begin(TraceKind kind, int64_t arg, const char *detail)
+{
+    emit('B', kind, arg, detail);
+}
+
+void trace_end(TraceKind kind)
+{
+    emit('E', kind, 0, NULL);
+}
+
+void trace_instant(TraceKind kind, int64_t arg, const char *detail)
+{
+    emit('i', kind, arg, detail);
+}
+
+/*=====================================================================
+ *  Export
+ *====================================================================*/
+typedef struct {
+    int    fd;
+    bool   dead;                  /* a write failed – drop the rest */
+    size_t len;
+    char   buf[8192];
+} Out;
+
+static void out_flush(Out *o)
+{
+    size_t off = 0;
+    while (off < o->len && !o->dead) {
+        ssize_t n = write(o->fd, o->buf + off, o->len - off);
+        if (n <= 0)
+            o->dead = true;       /* client went away or stopped reading */
+        else
+            off += (size_t)n;
+    }
+    o->len = 0;
+}
+
+static void out_str(Out *o, const char *s)
+{
+    size_t n = strlen(s);
+    if (o->len + n > sizeof o->buf)
+        out_flush(o);
+    memcpy(o->buf + o->len, s, n);
+    o->len += n;
+}
+
+/* JSON string body: quotes, backslashes and control bytes escaped */
+static void escape(char *dst, size_t cap, const char *src)
+{
+    size_t j = 0;
+    for (; *src && j + 7 < cap; ++src) {
+        unsigned char c = (unsigned char)*src;
+        if (c == '"' || c == '\\') {
+            dst[j++] = '\\';
+            dst[j++] = (char)c;
+        } else if (c < 0x20) {
+            j += (size_t)snprintf(dst + j, cap - j, "\\u%04x", c);
+        } else {
+            dst[j++] = (char)c;
+        }
+    }
+    dst[j] = '\0';
+}
+
+/* The dump works from a copy, taken by the caller in one quick pass;
+   ‘g_dumping’ keeps the next dump from overwriting it mid‑write. */
+static TraceSlot g_snap[TRACE_CAPACITY];
+static size_t    g_nsnap = 0;
+static bool      g_dumping = false;
+
+static void snapshot(void)
+{
+    const uint64_t head  = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+    const uint64_t first = head > TRACE_CAPACITY ? head - TRACE_CAPACITY : 0;
+
+    g_nsnap = 0;
+    for (uint64_t i = first; i < head; ++i) {
+        const TraceSlot *s = &g_ring[i & (TRACE_CAPACITY - 1)];
+        if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != i + 1)
+            continue;                           /* being (re)written */
+        TraceSlot e = *s;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != i + 1 ||
+            e.kind >= TR_KINDS)
+            continue;
+        g_snap[g_nsnap++] = e;
+    }
+}
+
+static void *dump_thread(void *arg)
+{
+    Out o = { .fd = (int)(intptr_t)arg, .len = 0 };
+    const int pid = (int)getpid();
+
+    /* A reader that stops reading ends the dump instead of parking us */
+    struct timeval tv = { TRACE_DUMP_TIMEOUT_S, 0 };
+    setsockopt(o.fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+
+    out_str(&o, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t k = 0; k < g_nsnap && !o.dead; ++k) {
+        const TraceSlot e = g_snap[k];
+
+        char detail[TRACE_DETAIL_MAX * 6 + 1];
+        escape(detail, sizeof detail, e.detail);
+
+        char line[512];
+        snprintf(line, sizeof line,
+                 "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",%s"
+                 "\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%u,"
+                 "\"args\":{\"arg\":%lld,\"detail\":\"%s\"}}",
+                 k ? ",\n" : "",
+                 kinds[e.kind].name, kinds[e.kind].cat, e.ph,
+                 e.ph == 'i' ? "\"s\":\"t\"," : "",
+                 (unsigned long long)(e.ts_ns / 1000),
+                 (unsigned)(e.ts_ns % 1000), pid, e.tid,
+                 (long long)e.arg, detail);
+        out_str(&o, line);
+    }
+    out_str(&o, "\n]}\n");
+    out_flush(&o);
+
+    close(o.fd);
+    __atomic_store_n(&g_dumping, false, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+bool trace_dump_async(int fd)
+{
+    if (__atomic_load_n(&g_dumping, __ATOMIC_ACQUIRE))
+        return false;
+    snapshot();
+
+    /* Formatting is no real‑time work: ordinary scheduling, whatever
+       the caller runs at */
+    pthread_attr_t attr;
+    struct sched_param sp = { .sched_priority = 0 };
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &sp);
+
+    pthread_t t;
+    g_dumping = true;
+    bool ok = pthread_create(&t, &attr, dump_thread,
+                             (void *)(intptr_t)fd) == 0;
+    pthread_attr_destroy(&attr);
+    if (!ok)
+        g_dumping = false;
+    return ok;
+}
@@ -0,0 +1,56 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/* -------------------------------------------------------------
+ *  In‑memory event trace.
+ *
+ *  A fixed ring of TRACE_CAPACITY timestamped events that always
+ *  runs: the daemon's stderr goes to /dev/null, so this is where you
+ *  look when an announcement came late.  Recording is lock‑free and
+ *  allocation‑free – one atomic increment claims a slot, which is then
+ *  published with a per‑slot sequence number – so it is safe on the
+ *  playback path and from any thread.  Old events are overwritten.
+ *
+ *  trace_dump_async() writes the ring as Chrome trace JSON, which
+ *  Perfetto (ui.perfetto.dev) and chrome://tracing open directly.
+ *
+ *  Single instance, handle‑less – like the audio API.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_CAPACITY    32768u     /* power of two; ~2 MB, twice  */
+#define TRACE_DETAIL_MAX  28
+
+typedef enum {
+    TR_TICK,          /* timerfd expiry; arg = seconds caught up      */
+    TR_PHASE,         /* phase change; arg = phase index              */
+    TR_COMMAND,       /* client command; detail = its text            */
+    TR_ANNOUNCE,      /* announcement played; detail = its type       */
+    TR_STAGE,         /* lookahead announcement staged                */
+    TR_CHAIN_ADD,     /* clip added to the chain; detail = asset      */
+    TR_PCM_CONFIG,    /* ALSA HW params set; arg = period frames      */
+    TR_PCM_WRITE,     /* one period to ALSA; arg = frames             */
+    TR_XRUN,          /* ALSA underrun                                */
+    TR_DRAIN,         /* waiting for ALSA to play out                 */
+    TR_CUE,           /* countdown cue queued; arg = cue slot         */
+    TR_SKIP,          /* fan‑out device caught up; arg = slots lost   */
+    TR_OPEN,          /* opening the device(s), in the background     */
+    TR_KINDS
+} TraceKind;
+
+/* Chrome trace phases: B/E bracket a duration, I is an instant */
+void trace_begin(TraceKind kind, int64_t arg, const char *detail);
+void trace_end(TraceKind kind);
+void trace_instant(TraceKind kind, int64_t arg, const char *detail);
+
+/* Write the ring, oldest first, as Chrome trace JSON to ‘fd’ and close
+ * it.  The ring is copied right away; formatting and writing happen on
+ * a thread of its own, so a slow reader holds up nobody – and one that
+ * stops reading for TRACE_DUMP_TIMEOUT_S gets the dump cut short.
+ * False, with ‘fd’ left open, while an earlier dump is still going. */
+#define TRACE_DUMP_TIMEOUT_S 5
+
+bool trace_dump_async(int fd);
+
+#endif /* TRACE_H */
@@ -0,0 +1,81 @@
+/*=====================================================================
+ *  wav.c  –  in‑place RIFF/WAV reader (see wav.h)
+ *====================================================================*/
+#include "wav.h"
+#include <string.h>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+static uint16_t le16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t le32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+           (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+bool wav_parse(const unsigned char *buf, size_t len, WavInfo *out)
+{
+    if (len < 12 || memcmp(buf, "RIFF", 4) != 0 ||
+        memcmp(buf + 8, "WAVE", 4) != 0)
+        return false;
+
+    const unsigned char *fmt = NULL;
+    const unsigned char *data = NULL;
+    size_t data_len = 0;
+
+    /* Walk the chunks; ‘fmt ’ and ‘data’ may come in either order */
+    size_t pos = 12;
+    while (pos + 8 <= len && (!fmt || !data)) {
+        const unsigned char *id = buf + pos;
+        size_t size = le32(buf + pos + 4);
+        size_t body = pos + 8;
+        size_t avail = len - body;
+
+        if (memcmp(id, "fmt ", 4) == 0) {
+            if (size < 16 || size > avail)
+                return false;
+            fmt = buf + body;
+        } else if (memcmp(id, "data", 4) == 0) {
+            data = buf + body;
+            data_len = size < avail ? size : avail;  /* truncated file */
+        }
+        if (size > avail)
+            break;
+        pos = body + size + (size & 1);              /* pad byte */
+    }
+    if (!fmt || !data)
+        return false;
+
+    uint16_t tag      = le16(fmt);
+    uint16_t channels = le16(fmt + 2);
+    uint32_t rate     = le32(fmt + 4);
+    uint16_t align    = le16(fmt + 12);
+    uint16_t bits     = le16(fmt + 14);
+
+    if (tag == WAVE_FORMAT_EXTENSIBLE && le32(fmt - 4) >= 40)
+        tag = le16(fmt + 24);                        /* sub‑format GUID */
+    if (tag != WAVE_FORMAT_PCM || bits != 16 || channels == 0 ||
+        align != 2u * channels || rate == 0)
+        return false;
+
+    out->rate     = rate;
+    out->channels = channels;
+    out->frames   = data_len / align;
+    out->pcm      = data;
+    return true;
+}
+
+void wav_copy_s16(int16_t *dst, const unsigned char *pcm, size_t samples)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(dst, pcm, samples * sizeof *dst);
+#else
+    for (size_t i = 0; i < samples; ++i)
+        dst[i] = (int16_t)le16(pcm + 2 * i);
+#endif
+}
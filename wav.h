@@ -0,0 +1,31 @@
+#ifndef WAV_H
+#define WAV_H
+
+/* -------------------------------------------------------------
+ *  In‑place RIFF/WAV reader.
+ *
+ *  The voice assets are plain 16‑bit PCM WAV files that are already
+ *  in memory (embedded arrays or the mmap'ed pack), so "decoding" is
+ *  finding the data chunk and copying samples out of it – no file
+ *  object, no allocation.
+ * ------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    unsigned int         rate;
+    unsigned int         channels;
+    size_t               frames;
+    const unsigned char *pcm;      /* S16‑LE interleaved, inside the file;
+                                      not necessarily 2‑byte aligned     */
+} WavInfo;
+
+/* Parse the header of the WAV file in ‘buf’.  Only 16‑bit PCM
+ * (WAVE_FORMAT_PCM or EXTENSIBLE with a PCM sub‑format) is accepted. */
+bool wav_parse(const unsigned char *buf, size_t len, WavInfo *out);
+
+/* Copy ‘samples’ samples starting at ‘pcm’ into native int16_t. */
+void wav_copy_s16(int16_t *dst, const unsigned char *pcm, size_t samples);
+
+#endif /* WAV_H */